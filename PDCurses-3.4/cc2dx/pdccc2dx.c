@@ -5,11 +5,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #ifdef WIN32
 #include <Windows.h>
+#include <sys/timeb.h>
 #else
 #include <unistd.h>
+#include <sys/time.h>
 #endif
 
 #ifdef CHTYPE_LONG
@@ -69,67 +72,508 @@ chtype acs_map[128] =
 
 #endif
 
-int ESCDELAY = 0;
-unsigned long pdc_key_modifiers = 0;
-#define PDC_rows 40
-#define PDC_cols 80
+PDCTLS int ESCDELAY = 0;
+PDCTLS unsigned long pdc_key_modifiers = 0;
 
-int pdc_last_key = -1;
-int pdc_update_count = 2;
-int pdc_consumers = 2;
+#ifdef WIN32
+#define PDC_BARRIER() MemoryBarrier()
+#else
+#define PDC_BARRIER() __sync_synchronize()
+#endif
+
+#define PDC_KEY_QUEUE 64
+#define PDC_EVENT_QUEUE 64
+
+/*
+ * everything one game shares with its ui: the key ring, the events,
+ * the frames and the screen behind them. each thread talks to the
+ * context bound to it, the main one unless bindScreenContext says
+ * otherwise, so several games can run side by side.
+ */
+struct _pdc_context {
+    // keys pushed by the ui thread, drained by the game thread. single
+    // producer / single consumer, so the indices need no lock; the mutex
+    // only parks the game thread while the ring is empty
+    int keyQueue[PDC_KEY_QUEUE];
+    volatile unsigned int keyHead;      /* next key to read */
+    volatile unsigned int keyTail;      /* next free slot */
+    volatile bool keyWaiting;           /* game thread is parked */
+    pthread_mutex_t keyMutex;
+    pthread_cond_t keyPushed;
+    pthread_cond_t keyIdle;
+    
+    // events pushed by the game thread, drained by the ui thread. a full
+    // ring drops its oldest event, which moves the head from the game
+    // side, so both sides hold eventMutex; nobody ever waits on it
+    t_pdc_event eventQueue[PDC_EVENT_QUEUE];
+    unsigned int eventHead;             /* next event to read */
+    unsigned int eventTail;             /* next free slot */
+    pthread_mutex_t eventMutex;
+    
+    // snapshot asked for by the ui thread, filled in by the game thread
+    // while it is parked waiting for a key so the game's lists are never
+    // read in the middle of a command. both sides hold keyMutex while
+    // touching these
+    void (*queryHandler)(t_pdc_snapshot *);
+    t_pdc_snapshot *queryPending;
+    bool queryDone;
+    pthread_cond_t queryAnswered;
+    
+    // spot the ui asked the hero to travel to, taken by the game thread
+    // when it reads PDC_KEY_TRAVEL. both sides hold keyMutex while
+    // touching these
+    int travelY;
+    int travelX;
+    
+    t_pdc_color color[16];
+    struct {short f, b;} atrtab[PDC_COLOR_PAIRS];
+    
+    // back buffer, only touched by the game thread
+    t_pdc_cell screenCells[PDC_cols*PDC_rows];
+    unsigned char screenThings[PDC_cols*PDC_rows];
+    t_pdc_frame_info screenInfo;
+    t_pdc_damage screenDamage;
+    
+    // last complete frame, published to the ui thread under a sequence
+    // lock; an odd sequence means a frame is being copied in. each
+    // published frame advances the generation by 2 and leaves its damage
+    // in the history ring
+    t_pdc_cell frameCells[PDC_cols*PDC_rows];
+    t_pdc_color framePalette[16];
+    unsigned char frameThings[PDC_cols*PDC_rows];
+    t_pdc_frame_info frameInfo;
+    t_pdc_damage frameDamage[PDC_DAMAGE_HISTORY];
+    volatile unsigned long frameSequence;
+    bool frameDirty;
+    
+    chtype oldch;                       /* current attribute */
+    short foregr, backgr;               /* current foreground, background */
+    t_pdc_cell cellattr;                /* current attribute, packed */
+};
+
+static t_pdc_context mainContext;
+static pthread_once_t mainContextOnce = PTHREAD_ONCE_INIT;
+static PDCTLS t_pdc_context *boundContext = NULL;
+
+static void _init_context(t_pdc_context *c)
+{
+    static const t_pdc_frame_info noInfo = { -1, -1, -1, -1, -1, -1, PDC_MODE_MAP };
+    
+    memset(c, 0, sizeof(*c));
+    pthread_mutex_init(&c->keyMutex, NULL);
+    pthread_mutex_init(&c->eventMutex, NULL);
+    pthread_cond_init(&c->keyPushed, NULL);
+    pthread_cond_init(&c->keyIdle, NULL);
+    pthread_cond_init(&c->queryAnswered, NULL);
+    c->travelY = -1;
+    c->travelX = -1;
+    c->screenInfo = noInfo;
+    c->frameInfo = noInfo;
+    c->oldch = (chtype)(-1);
+    c->foregr = -2;
+    c->backgr = -2;
+}
+
+static void _init_main_context(void)
+{
+    _init_context(&mainContext);
+}
 
-// count depends on number of consumers
-#define SET_SCREEN_DIRTY() pdc_update_count = pdc_consumers;
+static t_pdc_context *_context(void)
+{
+    if (boundContext == NULL) {
+        pthread_once(&mainContextOnce, _init_main_context);
+        boundContext = &mainContext;
+    }
+    return boundContext;
+}
 
-t_pdc_color pdc_color[16];
-static struct {short f, b;} atrtab[PDC_COLOR_PAIRS];
-char screenData[PDC_cols*PDC_rows];
-t_pdc_color screenColor[PDC_cols*PDC_rows];
+// keys come from pushKey here, never from a descriptor, so 'input' is
+// not used
+t_pdc_context *newScreenContext(int input)
+{
+    t_pdc_context *c = malloc(sizeof(t_pdc_context));
+    
+    if (c)
+        _init_context(c);
+    return c;
+}
 
-static chtype oldch = (chtype)(-1);    /* current attribute */
-static short foregr = -2, backgr = -2; /* current foreground, background */
+void freeScreenContext(t_pdc_context *c)
+{
+    if (c == NULL || c == &mainContext)
+        return;
+    
+    pthread_mutex_destroy(&c->keyMutex);
+    pthread_mutex_destroy(&c->eventMutex);
+    pthread_cond_destroy(&c->keyPushed);
+    pthread_cond_destroy(&c->keyIdle);
+    pthread_cond_destroy(&c->queryAnswered);
+    free(c);
+}
 
-void setUpdateConsumers(int c)
+/*
+ * makes every call from this thread, on the game or the ui side, talk
+ * to 'c'. NULL goes back to the main context.
+ */
+void bindScreenContext(t_pdc_context *c)
 {
-    pdc_consumers = c;
+    boundContext = c;
 }
 
-char *getScreenData()
+t_pdc_context *boundScreenContext(void)
 {
-    return screenData;
+    return _context();
 }
 
-t_pdc_color *getScreenColor()
+static void _abstime(int ms, struct timespec *ts)
 {
-    return screenColor;
+#ifdef WIN32
+    struct _timeb tb;
+    _ftime(&tb);
+    ts->tv_sec = tb.time;
+    ts->tv_nsec = tb.millitm * 1000000L;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    ts->tv_sec = tv.tv_sec;
+    ts->tv_nsec = tv.tv_usec * 1000L;
+#endif
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
 }
 
 void pushKey(int k) {
-    pdc_last_key = k;
+    t_pdc_context *c = _context();
+    unsigned int tail = c->keyTail;
+    
+    // a full ring means the game is not reading, drop the key
+    if (tail - c->keyHead >= PDC_KEY_QUEUE)
+        return;
+    
+    c->keyQueue[tail % PDC_KEY_QUEUE] = k;
+    PDC_BARRIER();
+    c->keyTail = tail + 1;
+    
+    pthread_mutex_lock(&c->keyMutex);
+    pthread_cond_signal(&c->keyPushed);
+    pthread_mutex_unlock(&c->keyMutex);
+}
+
+/*
+ * blocks the caller until the game thread has drained every pushed key
+ * and is waiting for more input, or 'ms' elapse. returns TRUE when idle.
+ */
+bool waitInputIdle(int ms)
+{
+    t_pdc_context *c = _context();
+    struct timespec ts;
+    bool idle;
+    
+    _abstime(ms, &ts);
+    
+    pthread_mutex_lock(&c->keyMutex);
+    while (!(c->keyWaiting && c->keyHead == c->keyTail)) {
+        if (pthread_cond_timedwait(&c->keyIdle, &c->keyMutex, &ts) != 0)
+            break;
+    }
+    idle = c->keyWaiting && c->keyHead == c->keyTail;
+    pthread_mutex_unlock(&c->keyMutex);
+    
+    return idle;
 }
 
-bool isScreenDirty()
+void setScreenQuery(void (*handler)(t_pdc_snapshot *))
 {
-    int i = pdc_update_count;
-    if (pdc_update_count > 0)
-        pdc_update_count--;
-    return i > 0;
+    t_pdc_context *c = _context();
+    
+    pthread_mutex_lock(&c->keyMutex);
+    c->queryHandler = handler;
+    pthread_mutex_unlock(&c->keyMutex);
+}
+
+/*
+ * asks the game thread to fill in 'snap' the next time it waits for a
+ * key. returns FALSE when the game has no handler or did not get to it
+ * within 'ms'; a query that was not started by then is withdrawn.
+ */
+bool queryScreenSnapshot(t_pdc_snapshot *snap, int ms)
+{
+    t_pdc_context *c = _context();
+    struct timespec ts;
+    bool done;
+    
+    _abstime(ms, &ts);
+    
+    pthread_mutex_lock(&c->keyMutex);
+    if (c->queryHandler == NULL || c->queryPending != NULL) {
+        pthread_mutex_unlock(&c->keyMutex);
+        return FALSE;
+    }
+    
+    c->queryPending = snap;
+    c->queryDone = FALSE;
+    pthread_cond_signal(&c->keyPushed);
+    while (!c->queryDone) {
+        if (pthread_cond_timedwait(&c->queryAnswered, &c->keyMutex, &ts) != 0)
+            break;
+    }
+    done = c->queryDone;
+    c->queryPending = NULL;
+    pthread_mutex_unlock(&c->keyMutex);
+    
+    return done;
+}
+
+/*
+ * sends the hero to 'y', 'x': the game walks there by itself, every step
+ * in its own turn, until it arrives or something worth stopping for
+ * turns up. a newer target replaces one the game has not read yet.
+ */
+void pushTravel(int y, int x)
+{
+    t_pdc_context *c = _context();
+    
+    pthread_mutex_lock(&c->keyMutex);
+    c->travelY = y;
+    c->travelX = x;
+    pthread_mutex_unlock(&c->keyMutex);
+    
+    pushKey(PDC_KEY_TRAVEL);
+}
+
+bool getTravelTarget(int *y, int *x)
+{
+    t_pdc_context *c = _context();
+    bool set;
+    
+    pthread_mutex_lock(&c->keyMutex);
+    set = c->travelY >= 0;
+    *y = c->travelY;
+    *x = c->travelX;
+    c->travelY = -1;
+    c->travelX = -1;
+    pthread_mutex_unlock(&c->keyMutex);
+    
+    return set;
+}
+
+static void _clear_damage(t_pdc_damage *damage)
+{
+    int i;
+    for (i = 0; i < PDC_rows; i++) {
+        damage->firstch[i] = _NO_CHANGE;
+        damage->lastch[i] = _NO_CHANGE;
+    }
+}
+
+static void _add_damage(t_pdc_damage *damage, int row, int first, int last)
+{
+    if (damage->firstch[row] == _NO_CHANGE || damage->firstch[row] > first)
+        damage->firstch[row] = first;
+    if (damage->lastch[row] < last)
+        damage->lastch[row] = last;
+}
+
+// damage between generation 'seen' and 'seq', the whole screen if the
+// history no longer reaches back that far
+static void _read_damage(t_pdc_context *c, t_pdc_damage *damage, unsigned long seen, unsigned long seq)
+{
+    unsigned long gen;
+    int i;
+    
+    if (seen == 0 || (seq - seen) / 2 > PDC_DAMAGE_HISTORY) {
+        for (i = 0; i < PDC_rows; i++) {
+            damage->firstch[i] = 0;
+            damage->lastch[i] = PDC_cols - 1;
+        }
+        return;
+    }
+    
+    _clear_damage(damage);
+    for (gen = seen + 2; gen <= seq; gen += 2) {
+        t_pdc_damage *fd = &c->frameDamage[(gen / 2) % PDC_DAMAGE_HISTORY];
+        for (i = 0; i < PDC_rows; i++) {
+            if (fd->firstch[i] != _NO_CHANGE)
+                _add_damage(damage, i, fd->firstch[i], fd->lastch[i]);
+        }
+    }
+}
+
+/*
+ * copies the last published frame if it is newer than generation 'seen'
+ * and returns its generation. 'palette' (may be 0) receives the 16
+ * colours the cells index, 'things' (may be 0) the object overlay, 'info'
+ * (may be 0) the hero, room and screen mode, and 'damage' (may be 0) the
+ * rows and columns that changed since 'seen'. pass 0 to always get a full
+ * frame.
+ */
+unsigned long readScreenFrame(t_pdc_cell *cells, t_pdc_color *palette, unsigned char *things, t_pdc_frame_info *info, t_pdc_damage *damage, int count, unsigned long seen)
+{
+    t_pdc_context *c = _context();
+    unsigned long seq;
+    
+    if (count > PDC_cols*PDC_rows)
+        count = PDC_cols*PDC_rows;
+    
+    do {
+        seq = c->frameSequence;
+        if (seq == seen)
+            return seen;
+        if (seq & 1)
+            continue;
+        
+        PDC_BARRIER();
+        memcpy(cells, c->frameCells, count * sizeof(t_pdc_cell));
+        if (palette)
+            memcpy(palette, c->framePalette, sizeof(c->framePalette));
+        if (things)
+            memcpy(things, c->frameThings, count);
+        if (info)
+            *info = c->frameInfo;
+        if (damage)
+            _read_damage(c, damage, seen, seq);
+        PDC_BARRIER();
+    } while ((seq & 1) || seq != c->frameSequence);
+    
+    return seq;
 }
 
 //-------------------------------------
 
 void PDC_transform_line(int lineno, int x, int len, const chtype *srcp);
 
-static void _set_attr(chtype ch, int row, int col)
+static void _publish_frame(t_pdc_context *c)
+{
+    if (!c->frameDirty)
+        return;
+    
+    c->frameSequence++;
+    PDC_BARRIER();
+    memcpy(c->frameCells, c->screenCells, sizeof(c->frameCells));
+    memcpy(c->framePalette, c->color, sizeof(c->framePalette));
+    memcpy(c->frameThings, c->screenThings, sizeof(c->frameThings));
+    c->frameInfo = c->screenInfo;
+    c->frameDamage[((c->frameSequence + 1) / 2) % PDC_DAMAGE_HISTORY] = c->screenDamage;
+    PDC_BARRIER();
+    c->frameSequence++;
+    
+    _clear_damage(&c->screenDamage);
+    c->frameDirty = FALSE;
+}
+
+// called by the game thread when an object is placed on or taken off a
+// cell, 'which' < 0 clears it. published with the next frame
+void setScreenThing(int row, int col, int which)
+{
+    t_pdc_context *c = _context();
+    unsigned char thing = which < 0 ? PDC_THING_NONE : (which & 0xff);
+    
+    if (row < 0 || row >= PDC_rows || col < 0 || col >= PDC_cols)
+        return;
+    if (c->screenThings[(row*PDC_cols) + col] == thing)
+        return;
+    
+    c->screenThings[(row*PDC_cols) + col] = thing;
+    _add_damage(&c->screenDamage, row, col, col);
+    c->frameDirty = TRUE;
+}
+
+void clearScreenThings(void)
+{
+    int i;
+    
+    for (i = 0; i < PDC_cols*PDC_rows; i++)
+        setScreenThing(i / PDC_cols, i % PDC_cols, -1);
+}
+
+// hero position and the bounds of the room he is in, -1 for none
+void setScreenHero(int y, int x, int top, int left, int bottom, int right)
+{
+    t_pdc_context *c = _context();
+    
+    if (c->screenInfo.hero_y == y && c->screenInfo.hero_x == x &&
+        c->screenInfo.room_top == top && c->screenInfo.room_left == left &&
+        c->screenInfo.room_bottom == bottom && c->screenInfo.room_right == right)
+        return;
+    
+    c->screenInfo.hero_y = y;
+    c->screenInfo.hero_x = x;
+    c->screenInfo.room_top = top;
+    c->screenInfo.room_left = left;
+    c->screenInfo.room_bottom = bottom;
+    c->screenInfo.room_right = right;
+    c->frameDirty = TRUE;
+}
+
+void setScreenMode(int mode)
+{
+    t_pdc_context *c = _context();
+    
+    if (c->screenInfo.mode == mode)
+        return;
+    
+    c->screenInfo.mode = mode;
+    c->frameDirty = TRUE;
+}
+
+void pushScreenEvent(const t_pdc_event *ev)
+{
+    t_pdc_context *c = _context();
+    t_pdc_event *last;
+    
+    pthread_mutex_lock(&c->eventMutex);
+    
+    // the hud only shows the newest stats, so a status nobody has read
+    // yet is brought up to date instead of queueing another behind it
+    if (ev->type == PDC_EVENT_STATUS && c->eventTail != c->eventHead) {
+        last = &c->eventQueue[(c->eventTail - 1) % PDC_EVENT_QUEUE];
+        if (last->type == PDC_EVENT_STATUS) {
+            *last = *ev;
+            pthread_mutex_unlock(&c->eventMutex);
+            return;
+        }
+    }
+    
+    // a full ring means the ui is not reading; drop the oldest event so
+    // it comes back to the newest messages and stats
+    if (c->eventTail - c->eventHead >= PDC_EVENT_QUEUE)
+        c->eventHead++;
+    
+    c->eventQueue[c->eventTail % PDC_EVENT_QUEUE] = *ev;
+    c->eventTail++;
+    pthread_mutex_unlock(&c->eventMutex);
+}
+
+bool popScreenEvent(t_pdc_event *ev)
+{
+    t_pdc_context *c = _context();
+    bool popped = FALSE;
+    
+    pthread_mutex_lock(&c->eventMutex);
+    if (c->eventHead != c->eventTail) {
+        *ev = c->eventQueue[c->eventHead % PDC_EVENT_QUEUE];
+        c->eventHead++;
+        popped = TRUE;
+    }
+    pthread_mutex_unlock(&c->eventMutex);
+    return popped;
+}
+
+static t_pdc_cell _set_attr(t_pdc_context *c, chtype ch)
 {
     ch &= (A_COLOR|A_BOLD|A_BLINK|A_REVERSE);
     
-    if (oldch != ch)
+    if (c->oldch != ch)
     {
         short newfg, newbg;
         
         if (SP->mono)
-            return;
+            return c->cellattr;
         
         PDC_pair_content(PAIR_NUMBER(ch), &newfg, &newbg);
         
@@ -143,25 +587,38 @@ static void _set_attr(chtype ch, int row, int col)
             newbg = tmp;
         }
         
-        if (newfg != foregr)
-        {
-            foregr = newfg;
-        }
+        c->foregr = newfg;
+        c->backgr = newbg;
         
-        if (newbg != backgr)
-        {
-            if (newbg == -1) {
-            } else {
-            }
-            
-            backgr = newbg;
-        }
+        // the default colours (-1) index black, which renders as white
+        c->cellattr = ((t_pdc_cell)(c->foregr < 0 ? 0 : c->foregr & 0xf) << 16) |
+            ((t_pdc_cell)(c->backgr < 0 ? 0 : c->backgr & 0xf) << 20);
+        if (ch & A_BOLD)
+            c->cellattr |= PDC_CELL_BOLD;
+        if (ch & A_REVERSE)
+            c->cellattr |= PDC_CELL_REVERSE;
+        if (ch & A_BLINK)
+            c->cellattr |= PDC_CELL_BLINK;
         
-        oldch = ch;
+        c->oldch = ch;
     }
     
-    t_pdc_color *clr = &screenColor[(row*SP->cols) + col];
-    *clr = pdc_color[foregr];
+    return c->cellattr;
+}
+
+static t_pdc_cell _make_cell(t_pdc_context *c, chtype ch)
+{
+    t_pdc_cell cell = _set_attr(c, ch);
+    
+    if (ch & A_ALTCHARSET)
+        cell |= PDC_CELL_ALTCHARSET;
+    
+#ifdef CHTYPE_LONG
+    if (ch & A_ALTCHARSET && !(ch & 0xff80))
+        ch = acs_map[ch & 0x7f];
+#endif
+    
+    return cell | (ch & PDC_CELL_GLYPH);
 }
 
 void PDC_beep(void)
@@ -177,17 +634,25 @@ bool PDC_can_change_color(void)
 
 bool PDC_check_key(void)
 {
+    t_pdc_context *c = _context();
+    
     //    fprintf(stdout, "bool PDC_check_key(void)\n");
-    return (pdc_last_key != -1);
+    
+    // doupdate only ends in PDC_gotoyx while the cursor is visible
+    _publish_frame(c);
+    
+    return (c->keyHead != c->keyTail);
 }
 
 int PDC_color_content(short color, short * red, short * green, short * blue)
 {
+    t_pdc_context *c = _context();
+    
     //    fprintf(stdout, "int PDC_color_content(short, short *, short *, short *)\n");
     
-    *red = pdc_color[color].r;
-    *green = pdc_color[color].g;
-    *blue = pdc_color[color].b;
+    *red = c->color[color].r;
+    *green = c->color[color].g;
+    *blue = c->color[color].b;
     
     return OK;
 }
@@ -228,11 +693,17 @@ int PDC_get_cursor_mode(void)
 
 int PDC_get_key(void)
 {
+    t_pdc_context *c = _context();
+    
     //    fprintf(stdout, "int PDC_get_key(void)\n");
     SP->key_code = 0;
-    if (pdc_last_key != -1) {
-        int k = pdc_last_key;
-        pdc_last_key = -1;
+    if (c->keyHead != c->keyTail) {
+        unsigned int head = c->keyHead;
+        int k;
+        PDC_BARRIER();
+        k = c->keyQueue[head % PDC_KEY_QUEUE];
+        PDC_BARRIER();
+        c->keyHead = head + 1;
         return k;
     }
     
@@ -247,48 +718,40 @@ int PDC_get_rows(void)
 
 void PDC_gotoyx(int row, int col)
 {
-    //    fprintf(stdout, "void PDC_gotoyx(int, int)\n");
-    
+    t_pdc_context *c = _context();
     chtype ch;
     int oldrow, oldcol;
     
-    SET_SCREEN_DIRTY()
-    
     oldrow = SP->cursrow;
     oldcol = SP->curscol;
     
-    //    screenData[(oldrow*SP->cols) + oldcol] = 0;
     PDC_transform_line(oldrow, oldcol, 1, curscr->_y[oldrow] + oldcol);
     
-    if (!SP->visibility)
+    if (!SP->visibility) {
+        _publish_frame(c);
         return;
+    }
     
     /* draw a new cursor by overprinting the existing character in
      reverse, either the full cell (when visibility == 2) or the
      lowest quarter of it (when visibility == 1) */
     ch = curscr->_y[row][col] ^ A_REVERSE;
     
-    _set_attr(ch, row, col);
+    c->screenCells[(row*SP->cols) + col] = _make_cell(c, ch);
+    _add_damage(&c->screenDamage, row, col, col);
+    c->frameDirty = TRUE;
     
-#ifdef CHTYPE_LONG
-    if (ch & A_ALTCHARSET && !(ch & 0xff80))
-        ch = acs_map[ch & 0x7f];
-#endif
-    
-    screenData[(row*SP->cols) + col] = ch;
-    
-    if (oldrow != row || oldcol != col) {
-        
-    }
+    // the cursor is placed last in doupdate, the frame is complete
+    _publish_frame(c);
 }
 
 int PDC_init_color(short color, short red, short green, short blue)
 {
-    //    fprintf(stdout, "int PDC_init_color(short, short, short, short)\n");
-    fprintf(stdout, "int PDC_init_color(%d, %d, %d, %d)\n", color, red, green, blue);
-    pdc_color[color].r = red;
-    pdc_color[color].g = green;
-    pdc_color[color].b = blue;
+    t_pdc_context *c = _context();
+    
+    c->color[color].r = red;
+    c->color[color].g = green;
+    c->color[color].b = blue;
     
     wrefresh(curscr);
     
@@ -297,9 +760,11 @@ int PDC_init_color(short color, short red, short green, short blue)
 
 void PDC_init_pair(short pair, short fg, short bg)
 {
+    t_pdc_context *c = _context();
+    
     //    fprintf(stdout, "void PDC_init_pair(short %d, short %d, short %d)\n", pair, fg, bg);
-    atrtab[pair].f = fg;
-    atrtab[pair].b = bg;
+    c->atrtab[pair].f = fg;
+    c->atrtab[pair].b = bg;
 }
 
 int PDC_modifiers_set(void)
@@ -316,19 +781,38 @@ int PDC_mouse_set(void)
 
 void PDC_napms(int p1)
 {
+    t_pdc_context *c = _context();
+    
 	//    fprintf(stdout, "void PDC_napms(int)\n");
-#ifdef WIN32
-	Sleep(p1 * 50 * 0.0001f);
-#else
-    usleep(p1 * 50);
-#endif
+    
+    // wgetch naps between PDC_check_key polls; park on the key ring
+    // instead, pushKey wakes us as soon as there is something to read
+    struct timespec ts;
+    _abstime(p1, &ts);
+    
+    pthread_mutex_lock(&c->keyMutex);
+    c->keyWaiting = TRUE;
+    pthread_cond_broadcast(&c->keyIdle);
+    while (c->keyHead == c->keyTail) {
+        if (c->queryPending != NULL && !c->queryDone) {
+            c->queryHandler(c->queryPending);
+            c->queryDone = TRUE;
+            pthread_cond_signal(&c->queryAnswered);
+            continue;
+        }
+        if (pthread_cond_timedwait(&c->keyPushed, &c->keyMutex, &ts) != 0)
+            break;
+    }
+    c->keyWaiting = FALSE;
+    pthread_mutex_unlock(&c->keyMutex);
 }
 
 int PDC_pair_content(short pair, short * fg, short * bg)
 {
+    t_pdc_context *c = _context();
     
-    *fg = atrtab[pair].f;
-    *bg = atrtab[pair].b;
+    *fg = c->atrtab[pair].f;
+    *bg = c->atrtab[pair].b;
     //    fprintf(stdout, "int PDC_pair_content(short, short * %d, short * %d)\n", *fg, *bg);
     return OK;
 }
@@ -371,12 +855,14 @@ void PDC_scr_close(void)
 
 void PDC_scr_free(void)
 {
-    fprintf(stdout, "void PDC_scr_free(void)\n");
-    
+    // delscreen clears SP once this returns
+    free(SP);
 }
 
 int PDC_scr_open(int p1, char ** p2)
 {
+    t_pdc_context *c = _context();
+    
     //    fprintf(stdout, "int PDC_scr_open(int, char **)\n");
     int i;
     
@@ -392,23 +878,26 @@ int PDC_scr_open(int p1, char ** p2)
     int off = 3;
     for (i = 0; i < 8; i++)
     {
-        pdc_color[i].r = ((i + off) & COLOR_RED) ? 0xf0 : 0x0;
-        pdc_color[i].g = ((i + off) & COLOR_GREEN) ? 0xf0 : 0x0;
-        pdc_color[i].b = ((i + off) & COLOR_BLUE) ? 0xf0 : 0x0;
+        c->color[i].r = ((i + off) & COLOR_RED) ? 0xf0 : 0x0;
+        c->color[i].g = ((i + off) & COLOR_GREEN) ? 0xf0 : 0x0;
+        c->color[i].b = ((i + off) & COLOR_BLUE) ? 0xf0 : 0x0;
         
-        pdc_color[i + 8].r = ((i + off) & COLOR_RED) ? 0xff : 0x40;
-        pdc_color[i + 8].g = ((i + off) & COLOR_GREEN) ? 0xff : 0x40;
-        pdc_color[i + 8].b = ((i + off) & COLOR_BLUE) ? 0xff : 0x40;
+        c->color[i + 8].r = ((i + off) & COLOR_RED) ? 0xff : 0x40;
+        c->color[i + 8].g = ((i + off) & COLOR_GREEN) ? 0xff : 0x40;
+        c->color[i + 8].b = ((i + off) & COLOR_BLUE) ? 0xff : 0x40;
         
-        //        fprintf(stdout, "%d %d %d\n", pdc_color[i].r, pdc_color[i].g, pdc_color[i].b);
+        //        fprintf(stdout, "%d %d %d\n", c->color[i].r, c->color[i].g, c->color[i].b);
     }
     
     SP->lines = PDC_get_rows();
     SP->cols = PDC_get_columns();
-    memset(screenData,0,sizeof(screenData));
-    memset(screenColor,0,sizeof(screenColor));
+    memset(c->screenCells,0,sizeof(c->screenCells));
+    memset(c->screenThings,PDC_THING_NONE,sizeof(c->screenThings));
     
-    SET_SCREEN_DIRTY()
+    for (i = 0; i < PDC_rows; i++)
+        _add_damage(&c->screenDamage, i, 0, PDC_cols - 1);
+    c->frameDirty = TRUE;
+    _publish_frame(c);
     
     return OK;
 }
@@ -436,9 +925,14 @@ const char *PDC_sysname(void)
 
 void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
 {
+    t_pdc_context *c = _context();
     
     //    fprintf(stdout, "void PDC_transform_line(int, int, int, const chtype *)\n");
-    SET_SCREEN_DIRTY()
+    if (len <= 0)
+        return;
+    
+    _add_damage(&c->screenDamage, lineno, x, x + len - 1);
+    c->frameDirty = TRUE;
     
     int j;
     for (j = 0; j < len; j++)
@@ -448,14 +942,7 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
         if (ch & (A_UNDERLINE|A_LEFTLINE|A_RIGHTLINE)) {
         }
         
-        _set_attr(ch, lineno, x + j);
-        
-#ifdef CHTYPE_LONG
-        if (ch & A_ALTCHARSET && !(ch & 0xff80))
-            ch = (ch & (A_ATTRIBUTES ^ A_ALTCHARSET)) | acs_map[ch & 0x7f];
-#endif
-        
-        screenData[(lineno * SP->cols) + x + j] = ch;
+        c->screenCells[(lineno * SP->cols) + x + j] = _make_cell(c, ch);
     }
 }
 
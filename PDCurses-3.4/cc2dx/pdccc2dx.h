@@ -3,10 +3,130 @@
 
 #include <curses.h>
 
+#define PDC_rows 40
+#define PDC_cols 80
+
+/* frames of damage kept for readers that fall behind */
+#define PDC_DAMAGE_HISTORY 16
+
+/*
+ * one game's screen, key ring and events. the main context serves any
+ * thread that has not bound another one with bindScreenContext; a
+ * process running several games gives each its own from
+ * newScreenContext and binds it on both the game and the ui side
+ */
+typedef struct _pdc_context t_pdc_context;
+
 typedef struct _pdc_color {
     unsigned short r;
     unsigned short g;
     unsigned short b;
 } t_pdc_color;
 
+/*
+ * one screen cell: the glyph (alternate charset already resolved), the
+ * foreground and background palette index with bold and reverse applied,
+ * and the attribute flags the glyph was drawn with
+ */
+typedef unsigned int t_pdc_cell;
+
+#define PDC_CELL_GLYPH      0x0000ffff
+#define PDC_CELL_BOLD       0x01000000
+#define PDC_CELL_REVERSE    0x02000000
+#define PDC_CELL_BLINK      0x04000000
+#define PDC_CELL_ALTCHARSET 0x08000000
+
+#define PDC_CELL_FG(c)      (((c) >> 16) & 0xf)
+#define PDC_CELL_BG(c)      (((c) >> 20) & 0xf)
+
+/* object kind overlay: the game's subtype of the object lying on a cell */
+#define PDC_THING_NONE      0xff
+
+/* what the game is showing, see t_pdc_frame_info */
+#define PDC_MODE_MAP        0
+#define PDC_MODE_MENU       1
+#define PDC_MODE_END        2
+
+/* published with every frame, -1 for anything the game has not set */
+typedef struct _pdc_frame_info {
+    short hero_y;
+    short hero_x;
+    short room_top;
+    short room_left;
+    short room_bottom;
+    short room_right;
+    short mode;
+} t_pdc_frame_info;
+
+/* key pushed by pushTravel, the game's TRAVEL command (^_) */
+#define PDC_KEY_TRAVEL      0x1f
+
+/* events the game pushes for the ui, drained with popScreenEvent */
+#define PDC_EVENT_MESSAGE   1   /* text is the new message line, "" clears it */
+#define PDC_EVENT_PROMPT    2   /* the game waits for an answer of 'kind' */
+#define PDC_EVENT_STATUS    3   /* new stats, text is the status line */
+
+#define PDC_PROMPT_MORE     1   /* --More-- */
+#define PDC_PROMPT_NAME     2   /* what do you want to call it? */
+#define PDC_PROMPT_IDENTIFY 3   /* what do you want identified? */
+#define PDC_PROMPT_ITEM     4   /* which object ... (* for list) */
+#define PDC_PROMPT_HAND     5   /* left hand or right hand? */
+
+typedef struct _pdc_stats {
+    int level;
+    int gold;
+    int hp;
+    int hp_max;
+    int str;
+    int str_max;
+    int arm;
+    int exp_level;
+    int exp;
+    int hunger;
+} t_pdc_stats;
+
+typedef struct _pdc_event {
+    int type;
+    int kind;
+    t_pdc_stats stats;
+    char text[PDC_cols + 1];
+} t_pdc_event;
+
+/* what an item is to the player, see t_pdc_item */
+#define PDC_ITEM_WIELDED    0x01
+#define PDC_ITEM_WORN       0x02
+#define PDC_ITEM_LEFT_HAND  0x04
+#define PDC_ITEM_RIGHT_HAND 0x08
+#define PDC_ITEM_KNOWN      0x10    /* its kind has been identified */
+#define PDC_ITEM_PICKABLE   0x20    /* fits the pending item prompt */
+
+#define PDC_SNAPSHOT_ITEMS       32
+#define PDC_SNAPSHOT_DISCOVERIES 64
+
+typedef struct _pdc_item {
+    char letter;                /* pack letter, 0 for discoveries */
+    char type;                  /* object glyph, ! ? = / ) ] : , */
+    short which;
+    short count;
+    short flags;
+    char name[PDC_cols + 1];
+} t_pdc_item;
+
+/* the pack, what has been discovered and the stats, filled in by the
+   game thread for queryScreenSnapshot */
+typedef struct _pdc_snapshot {
+    t_pdc_stats stats;
+    int picking;                /* an item prompt is waiting for an answer */
+    int item_count;
+    t_pdc_item items[PDC_SNAPSHOT_ITEMS];
+    int discovery_count;
+    t_pdc_item discoveries[PDC_SNAPSHOT_DISCOVERIES];
+} t_pdc_snapshot;
+
+/* changed span of each row, _NO_CHANGE (-1) when the row is untouched */
+typedef struct _pdc_damage {
+    short firstch[PDC_rows];
+    short lastch[PDC_rows];
+} t_pdc_damage;
+
 #endif
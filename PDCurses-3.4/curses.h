@@ -341,17 +341,26 @@ typedef struct
 # define PDCEX extern
 #endif
 
-PDCEX  int          LINES;        /* terminal height */
-PDCEX  int          COLS;         /* terminal width */
-PDCEX  WINDOW       *stdscr;      /* the default screen window */
-PDCEX  WINDOW       *curscr;      /* the current screen image */
-PDCEX  SCREEN       *SP;          /* curses variables */
-PDCEX  MOUSE_STATUS Mouse_status;
-PDCEX  int          COLORS;
-PDCEX  int          COLOR_PAIRS;
-PDCEX  int          TABSIZE;
+/* with PDC_THREADS every thread that runs curses gets its own screen,
+   windows and settings */
+
+#ifdef PDC_THREADS
+# define PDCTLS __thread
+#else
+# define PDCTLS
+#endif
+
+PDCEX  PDCTLS int          LINES;        /* terminal height */
+PDCEX  PDCTLS int          COLS;         /* terminal width */
+PDCEX  PDCTLS WINDOW       *stdscr;      /* the default screen window */
+PDCEX  PDCTLS WINDOW       *curscr;      /* the current screen image */
+PDCEX  PDCTLS SCREEN       *SP;          /* curses variables */
+PDCEX  PDCTLS MOUSE_STATUS Mouse_status;
+PDCEX  PDCTLS int          COLORS;
+PDCEX  PDCTLS int          COLOR_PAIRS;
+PDCEX  PDCTLS int          TABSIZE;
 PDCEX  chtype       acs_map[];    /* alternate character set map */
-PDCEX  char         ttytype[];    /* terminal name/description */
+PDCEX  PDCTLS char         ttytype[];    /* terminal name/description */
 
 /*man-start**************************************************************
 
@@ -52,11 +52,11 @@ typedef struct           /* structure for ripped off lines */
 #define _DWCHAR    0x17  /* Delete Word char (^W) */
 #define _DLCHAR    0x15  /* Delete Line char (^U) */
 
-extern WINDOW *pdc_lastscr;
-extern bool pdc_trace_on;   /* tracing flag */
-extern bool pdc_color_started;
-extern unsigned long pdc_key_modifiers;
-extern MOUSE_STATUS pdc_mouse_status;
+extern PDCTLS WINDOW *pdc_lastscr;
+extern PDCTLS bool pdc_trace_on;   /* tracing flag */
+extern PDCTLS bool pdc_color_started;
+extern PDCTLS unsigned long pdc_key_modifiers;
+extern PDCTLS MOUSE_STATUS pdc_mouse_status;
 
 /*----------------------------------------------------------------------*/
 
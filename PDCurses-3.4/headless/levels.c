@@ -0,0 +1,414 @@
+/*
+ * levels: dig rogue levels as fast as they come, time each part of the
+ * digging and check every level that comes out
+ *
+ *	levels [-n count] [-s seed] [-l first] [-d last] [-t threads] [-v]
+ *
+ * Level i is dug from seed + i at depth first + i % (last - first + 1),
+ * so a bad level is dug again on its own with
+ *
+ *	levels -n 1 -s digseed -l depth -d depth -v
+ *
+ * Built with PDC_THREADS (THREADS=Y) the count is shared out over one
+ * thread per processor, each digging into its own copy of the level.
+ * The sum of the level hashes comes out the same however many threads
+ * dug them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef PDC_THREADS
+#include <pthread.h>
+#endif
+#include <curses.h>
+#include "rogue.h"
+
+#define P_ROOMS		0
+#define P_PASSAGES	1
+#define P_THINGS	2
+#define P_STAIRS	3
+#define P_CHECK		4
+#define NPHASES		5
+
+static const char *phase_name[NPHASES] = {
+    "do_rooms", "do_passages", "put_things", "put_stairs", "check"
+};
+
+typedef struct {
+    int w_first;		/* the levels this worker digs ... */
+    int w_step;
+    double w_ns[NPHASES];	/* ... and what it made of them */
+    long w_dug;
+    long w_bad;
+    unsigned int w_hash;
+} WORKER;
+
+static long nlevels = 1000000;
+static unsigned int base_seed;
+static int first_level = 1;
+static int last_level = AMULETLEVEL;
+static int verbose = FALSE;
+
+static double
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * passable:
+ *	Can the hero get through this spot, once its secrets are found
+ */
+static int
+passable(int y, int x)
+{
+    int ch = chat(y, x);
+    int fl = flat(y, x);
+
+    if ((fl & F_PASS) || !(fl & F_REAL))
+	return TRUE;
+    return ch != ' ' && ch != '|' && ch != '-';
+}
+
+/*
+ * flood:
+ *	Mark every spot the hero can walk to from where the hero starts
+ */
+static void
+flood(char seen[NUMLINES][NUMCOLS])
+{
+    static const int dy[4] = { -1, 1, 0, 0 }, dx[4] = { 0, 0, -1, 1 };
+    coord stack[NUMLINES * NUMCOLS], cur;
+    int sp, i, y, x;
+
+    memset(seen, 0, NUMLINES * NUMCOLS);
+    sp = 0;
+    stack[sp++] = hero;
+    seen[hero.y][hero.x] = 1;
+    while (sp > 0)
+    {
+	cur = stack[--sp];
+	for (i = 0; i < 4; i++)
+	{
+	    y = cur.y + dy[i];
+	    x = cur.x + dx[i];
+	    if (y < 1 || y >= NUMLINES - 1 || x < 0 || x >= NUMCOLS
+		|| seen[y][x] || !passable(y, x))
+		continue;
+	    seen[y][x] = 1;
+	    stack[sp].y = y;
+	    stack[sp++].x = x;
+	}
+    }
+}
+
+/*
+ * room_reached:
+ *	Did the flood get anywhere inside the room
+ */
+static int
+room_reached(const struct room *rp, char seen[NUMLINES][NUMCOLS])
+{
+    int y, x;
+
+    for (y = rp->r_pos.y; y < rp->r_pos.y + rp->r_max.y; y++)
+	for (x = rp->r_pos.x; x < rp->r_pos.x + rp->r_max.x; x++)
+	    if (seen[y][x])
+		return TRUE;
+    return FALSE;
+}
+
+/*
+ * check_dug:
+ *	What is wrong with the level just dug, NULL if nothing
+ */
+static const char *
+check_dug(void)
+{
+    static TLOCAL char why[MAXSTR];
+    char seen[NUMLINES][NUMCOLS];
+    struct room *rp, *op;
+    THING *tp;
+    int y, x, nstairs, pnum;
+
+    if (mpos != 0)
+	return "digging put up a message";
+    for (rp = rooms; rp < &rooms[MAXROOMS]; rp++)
+    {
+	if (rp->r_nexits > 12)
+	    return "a room has too many exits";
+	if (rp->r_flags & ISGONE)
+	    continue;
+	if (rp->r_pos.y < 1 || rp->r_pos.x < 0
+	    || rp->r_pos.y + rp->r_max.y > NUMLINES - 1
+	    || rp->r_pos.x + rp->r_max.x > NUMCOLS)
+	    return "a room is off the map";
+	for (op = rooms; op < rp; op++)
+	    if (!(op->r_flags & ISGONE)
+		&& rp->r_pos.x < op->r_pos.x + op->r_max.x
+		&& op->r_pos.x < rp->r_pos.x + rp->r_max.x
+		&& rp->r_pos.y < op->r_pos.y + op->r_max.y
+		&& op->r_pos.y < rp->r_pos.y + rp->r_max.y)
+	    {
+		sprintf(why, "rooms %d and %d overlap",
+		    (int) (op - rooms), (int) (rp - rooms));
+		return why;
+	    }
+    }
+
+    nstairs = 0;
+    pnum = 0;
+    for (y = 1; y < NUMLINES - 1; y++)
+	for (x = 0; x < NUMCOLS; x++)
+	{
+	    if (chat(y, x) == STAIRS)
+		nstairs++;
+	    if ((flat(y, x) & F_PASS) && (flat(y, x) & F_PNUM) > pnum)
+		pnum = flat(y, x) & F_PNUM;
+	}
+    if (nstairs != 1 || chat(stairs.y, stairs.x) != STAIRS)
+    {
+	sprintf(why, "%d staircases", nstairs);
+	return why;
+    }
+    if (pnum >= MAXPASS)
+    {
+	sprintf(why, "passage %d, only %d allowed", pnum, MAXPASS);
+	return why;
+    }
+    for (rp = passages; rp < &passages[MAXPASS]; rp++)
+	if (rp->r_nexits > 12)
+	    return "a passage has too many exits";
+
+    if (moat(hero.y, hero.x) != NULL || !passable(hero.y, hero.x))
+	return "the hero has nowhere to stand";
+    flood(seen);
+    if (!seen[stairs.y][stairs.x])
+	return "the stairs cannot be reached";
+    for (rp = rooms; rp < &rooms[MAXROOMS]; rp++)
+	if (!(rp->r_flags & ISGONE) && !room_reached(rp, seen))
+	{
+	    sprintf(why, "room %d cannot be reached", (int) (rp - rooms));
+	    return why;
+	}
+    for (tp = lvl_obj; tp != NULL; tp = next(tp))
+	if (!seen[tp->o_pos.y][tp->o_pos.x])
+	    return "a thing cannot be reached";
+    for (tp = mlist; tp != NULL; tp = next(tp))
+	if (!seen[tp->t_pos.y][tp->t_pos.x])
+	    return "a monster cannot be reached";
+    return NULL;
+}
+
+/*
+ * show_level:
+ *	Print the map of a bad level
+ */
+static void
+show_level(unsigned int dseed, int depth, const char *why)
+{
+    char buf[NUMLINES * (NUMCOLS + 1) + MAXSTR];
+    char *bp;
+    THING *tp;
+    int y, x;
+
+    bp = buf + sprintf(buf, "seed %u level %d: %s\n", dseed, depth, why);
+    if (verbose)
+	for (y = 1; y < NUMLINES - 1; y++)
+	{
+	    for (x = 0; x < NUMCOLS; x++)
+		if (y == hero.y && x == hero.x)
+		    *bp++ = PLAYER;
+		else if ((tp = moat(y, x)) != NULL)
+		    *bp++ = tp->t_type;
+		else
+		    *bp++ = chat(y, x);
+	    *bp++ = '\n';
+	}
+    *bp = '\0';
+    fputs(buf, stderr);
+}
+
+/*
+ * dig_levels:
+ *	Dig this worker's share of the levels, one after the other in
+ *	its own copy of the map
+ */
+static void *
+dig_levels(void *arg)
+{
+    WORKER *wp = arg;
+    double t[NPHASES + 1];
+    const char *why;
+    unsigned int dseed;
+    int depth, p;
+    long i;
+
+    digging = TRUE;
+    seed = base_seed;
+    init_probs();
+    init_materials();
+    for (i = wp->w_first; i < nlevels; i += wp->w_step)
+    {
+	drop_level();
+	clear_places();
+	dseed = base_seed + (unsigned int) i;
+	depth = first_level + (int) (i % (last_level - first_level + 1));
+	seed = dseed;
+	level = max_level = depth;
+	amulet = FALSE;
+	no_food = (int) (i % 4);
+	group = 2;
+	mpos = 0;
+
+	t[P_ROOMS] = now_ns();
+	do_rooms();
+	t[P_PASSAGES] = now_ns();
+	do_passages();
+	no_food++;
+	t[P_THINGS] = now_ns();
+	put_things();
+	t[P_STAIRS] = now_ns();
+	put_stairs();
+	t[P_CHECK] = now_ns();
+	why = check_dug();
+	t[NPHASES] = now_ns();
+
+	for (p = 0; p < NPHASES; p++)
+	    wp->w_ns[p] += t[p + 1] - t[p];
+	wp->w_dug++;
+	wp->w_hash += state_hash();
+	if (why != NULL)
+	{
+	    wp->w_bad++;
+	    show_level(dseed, depth, why);
+	}
+    }
+    drop_level();
+    free_things();
+    return NULL;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n count] [-s seed] [-l first] [-d last] [-t threads] [-v]\n", prog);
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    WORKER *workers;
+    double start, secs, ns[NPHASES];
+    long dug, bad;
+    unsigned int hash;
+    int opt, nthreads, i, p;
+
+    base_seed = (unsigned int) time(NULL);
+#ifdef PDC_THREADS
+    nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    nthreads = 1;
+#endif
+    while ((opt = getopt(argc, argv, "n:s:l:d:t:v")) != -1)
+	switch (opt)
+	{
+	    case 'n':
+		nlevels = atol(optarg);
+		break;
+	    case 's':
+		base_seed = (unsigned int) strtoul(optarg, NULL, 0);
+		break;
+	    case 'l':
+		first_level = atoi(optarg);
+		break;
+	    case 'd':
+		last_level = atoi(optarg);
+		break;
+	    case 't':
+		nthreads = atoi(optarg);
+		break;
+	    case 'v':
+		verbose = TRUE;
+		break;
+	    default:
+		usage(argv[0]);
+	}
+    if (optind != argc || nlevels < 0 || first_level < 1
+	|| last_level < first_level)
+	usage(argv[0]);
+#ifndef PDC_THREADS
+    if (nthreads != 1)
+	fprintf(stderr, "%s: one thread only, build with THREADS=Y for more\n",
+	    argv[0]);
+    nthreads = 1;
+#endif
+    if (nthreads < 1)
+	nthreads = 1;
+    if ((workers = calloc(nthreads, sizeof *workers)) == NULL)
+    {
+	perror(argv[0]);
+	exit(1);
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+	workers[i].w_first = i;
+	workers[i].w_step = nthreads;
+    }
+
+    printf("digging %ld levels from seed %u, levels %d-%d, %d thread%s\n",
+	nlevels, base_seed, first_level, last_level, nthreads,
+	nthreads == 1 ? "" : "s");
+    fflush(stdout);
+    start = now_ns();
+#ifdef PDC_THREADS
+    {
+	pthread_t *threads;
+
+	if ((threads = calloc(nthreads, sizeof *threads)) == NULL)
+	{
+	    perror(argv[0]);
+	    exit(1);
+	}
+	for (i = 0; i < nthreads; i++)
+	    if (pthread_create(&threads[i], NULL, dig_levels, &workers[i]) != 0)
+	    {
+		perror("pthread_create");
+		exit(1);
+	    }
+	for (i = 0; i < nthreads; i++)
+	    pthread_join(threads[i], NULL);
+	free(threads);
+    }
+#else
+    dig_levels(&workers[0]);
+#endif
+    secs = (now_ns() - start) / 1e9;
+
+    dug = bad = 0;
+    hash = 0;
+    memset(ns, 0, sizeof ns);
+    for (i = 0; i < nthreads; i++)
+    {
+	dug += workers[i].w_dug;
+	bad += workers[i].w_bad;
+	hash += workers[i].w_hash;
+	for (p = 0; p < NPHASES; p++)
+	    ns[p] += workers[i].w_ns[p];
+    }
+    printf("dug %ld levels in %.2fs, %.0f levels/s\n", dug, secs,
+	secs > 0 ? dug / secs : 0.0);
+    for (p = 0; p < NPHASES; p++)
+	printf("  %-12s %8.2f us/level\n", phase_name[p],
+	    dug > 0 ? ns[p] / dug / 1e3 : 0.0);
+    printf("level hash %08x, %ld bad\n", hash, bad);
+    free(workers);
+    return bad != 0;
+}
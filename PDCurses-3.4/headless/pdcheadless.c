@@ -0,0 +1,431 @@
+#include "pdcheadless.h"
+
+#include <curses.h>
+#include <curspriv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+
+#ifdef CHTYPE_LONG
+
+# define A(x) ((chtype)x | A_ALTCHARSET)
+
+chtype acs_map[128] =
+{
+    A(0), A(1), A(2), A(3), A(4), A(5), A(6), A(7), A(8), A(9),
+    A(10), A(11), A(12), A(13), A(14), A(15), A(16), A(17), A(18),
+    A(19), A(20), A(21), A(22), A(23), A(24), A(25), A(26), A(27),
+    A(28), A(29), A(30), A(31), ' ', '!', '"', '#', '$', '%', '&',
+    '\'', '(', ')', '*',
+    
+# ifdef PDC_WIDE
+    0x2192, 0x2190, 0x2191, 0x2193,
+# else
+    A(0x1a), A(0x1b), A(0x18), A(0x19),
+# endif
+    
+    '/',
+    
+# ifdef PDC_WIDE
+    0x2588,
+# else
+    0xdb,
+# endif
+    
+    '1', '2', '3', '4', '5', '6', '7', '8', '9', ':', ';', '<', '=',
+    '>', '?', '@', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J',
+    'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W',
+    'X', 'Y', 'Z', '[', '\\', ']', '^', '_',
+    
+# ifdef PDC_WIDE
+    0x2666, 0x2592,
+# else
+    A(0x04), 0xb1,
+# endif
+    
+    'b', 'c', 'd', 'e',
+    
+# ifdef PDC_WIDE
+    0x00b0, 0x00b1, 0x2591, 0x00a4, 0x2518, 0x2510, 0x250c, 0x2514,
+    0x253c, 0x23ba, 0x23bb, 0x2500, 0x23bc, 0x23bd, 0x251c, 0x2524,
+    0x2534, 0x252c, 0x2502, 0x2264, 0x2265, 0x03c0, 0x2260, 0x00a3,
+    0x00b7,
+# else
+    0xf8, 0xf1, 0xb0, A(0x0f), 0xd9, 0xbf, 0xda, 0xc0, 0xc5, 0x2d,
+    0x2d, 0xc4, 0x2d, 0x5f, 0xc3, 0xb4, 0xc1, 0xc2, 0xb3, 0xf3,
+    0xf2, 0xe3, 0xd8, 0x9c, 0xf9,
+# endif
+    
+    A(127)
+};
+
+# undef A
+
+#endif
+
+PDCTLS int ESCDELAY = 0;
+PDCTLS unsigned long pdc_key_modifiers = 0;
+
+#define PDC_INPUT_BUFFER 4096
+
+/*
+ * one game's key source and screen. as with cc2dx each thread talks to
+ * the context bound to it, the main one unless bindScreenContext says
+ * otherwise. only the game thread ever touches it, so there is no lock
+ */
+struct _pdc_context {
+    // keys read ahead from inputFd
+    int inputFd;
+    unsigned char input[PDC_INPUT_BUFFER];
+    int inputHead;                      /* next key to read */
+    int inputTail;                      /* end of what was read */
+    bool inputEnded;                    /* inputFd hit end of file */
+    
+    struct {short f, b;} atrtab[PDC_COLOR_PAIRS];
+    short color[16][3];
+    
+    chtype screen[PDC_cols*PDC_rows];
+};
+
+// all zero is a good main context: keys from stdin, a blank screen
+static t_pdc_context mainContext;
+static PDCTLS t_pdc_context *boundContext = NULL;
+
+static t_pdc_context *_context(void)
+{
+    if (boundContext == NULL)
+        boundContext = &mainContext;
+    return boundContext;
+}
+
+t_pdc_context *newScreenContext(int input)
+{
+    t_pdc_context *c = calloc(1, sizeof(t_pdc_context));
+    
+    if (c)
+        c->inputFd = input;
+    return c;
+}
+
+void freeScreenContext(t_pdc_context *c)
+{
+    if (c == NULL || c == &mainContext)
+        return;
+    
+    free(c);
+}
+
+void bindScreenContext(t_pdc_context *c)
+{
+    boundContext = c;
+}
+
+t_pdc_context *boundScreenContext(void)
+{
+    return _context();
+}
+
+void setHeadlessInput(int fd)
+{
+    t_pdc_context *c = _context();
+    
+    c->inputFd = fd;
+    c->inputHead = 0;
+    c->inputTail = 0;
+    c->inputEnded = FALSE;
+}
+
+void writeHeadlessScreen(FILE *fp)
+{
+    t_pdc_context *c = _context();
+    char line[PDC_cols + 1];
+    int row, col, len;
+    
+    for (row = 0; row < PDC_rows; row++) {
+        len = 0;
+        for (col = 0; col < PDC_cols; col++) {
+            int ch = c->screen[(row*PDC_cols) + col] & A_CHARTEXT;
+            
+            if (ch < ' ' || ch > '~')
+                ch = ch ? '?' : ' ';
+            line[col] = ch;
+            if (ch != ' ')
+                len = col + 1;
+        }
+        line[len] = '\0';
+        fprintf(fp, "%s\n", line);
+    }
+    fflush(fp);
+}
+
+// reads whatever keys are waiting, blocking for up to 'ms' (-1 for
+// ever) if there are none. true once there is a key or the input ended
+static bool _fill_input(t_pdc_context *c, int ms)
+{
+    struct pollfd pfd;
+    ssize_t n;
+    
+    if (c->inputHead < c->inputTail || c->inputEnded)
+        return TRUE;
+    
+    pfd.fd = c->inputFd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, ms) <= 0)
+        return FALSE;
+    
+    n = read(c->inputFd, c->input, sizeof(c->input));
+    if (n <= 0) {
+        c->inputEnded = TRUE;
+        return TRUE;
+    }
+    
+    c->inputHead = 0;
+    c->inputTail = (int)n;
+    return TRUE;
+}
+
+// the game side of the cc2dx interface. there is no ui to tell about
+// objects, the hero or events, and nobody to ask for a travel target
+
+void setScreenThing(int row, int col, int which)
+{
+}
+
+void clearScreenThings(void)
+{
+}
+
+void setScreenHero(int y, int x, int top, int left, int bottom, int right)
+{
+}
+
+void setScreenMode(int mode)
+{
+}
+
+void pushScreenEvent(const t_pdc_event *ev)
+{
+}
+
+void setScreenQuery(void (*handler)(t_pdc_snapshot *))
+{
+}
+
+bool getTravelTarget(int *y, int *x)
+{
+    return FALSE;
+}
+
+void PDC_beep(void)
+{
+}
+
+bool PDC_can_change_color(void)
+{
+    return TRUE;
+}
+
+bool PDC_check_key(void)
+{
+    return _fill_input(_context(), 0);
+}
+
+int PDC_color_content(short color, short * red, short * green, short * blue)
+{
+    t_pdc_context *c = _context();
+    
+    *red = c->color[color][0];
+    *green = c->color[color][1];
+    *blue = c->color[color][2];
+    
+    return OK;
+}
+
+int PDC_curs_set(int visibility)
+{
+    int ret_vis;
+    
+    PDC_LOG(("PDC_curs_set() - called: visibility=%d\n", visibility));
+    
+    ret_vis = SP->visibility;
+    SP->visibility = visibility;
+    
+    return ret_vis;
+}
+
+void PDC_flushinp(void)
+{
+    // a script is typed ahead on purpose, never throw it away
+}
+
+int PDC_get_columns(void)
+{
+    return PDC_cols;
+}
+
+int PDC_get_cursor_mode(void)
+{
+    return 0;
+}
+
+int PDC_get_key(void)
+{
+    t_pdc_context *c = _context();
+    
+    SP->key_code = 0;
+    _fill_input(c, -1);
+    if (c->inputHead < c->inputTail)
+        return c->input[c->inputHead++];
+    
+    // out of keys: nothing more will ever happen in this game. say so
+    // on every read and let the game wind itself down
+    SP->key_code = TRUE;
+    return KEY_EXIT;
+}
+
+int PDC_get_rows(void)
+{
+    return PDC_rows;
+}
+
+void PDC_gotoyx(int row, int col)
+{
+}
+
+int PDC_init_color(short color, short red, short green, short blue)
+{
+    t_pdc_context *c = _context();
+    
+    c->color[color][0] = red;
+    c->color[color][1] = green;
+    c->color[color][2] = blue;
+    
+    return OK;
+}
+
+void PDC_init_pair(short pair, short fg, short bg)
+{
+    t_pdc_context *c = _context();
+    
+    c->atrtab[pair].f = fg;
+    c->atrtab[pair].b = bg;
+}
+
+int PDC_modifiers_set(void)
+{
+    return OK;
+}
+
+int PDC_mouse_set(void)
+{
+    return OK;
+}
+
+void PDC_napms(int ms)
+{
+    // wgetch naps between PDC_check_key polls. never sleep for the sake
+    // of it: come back as soon as a key can be read, at once for a file
+    _fill_input(_context(), ms);
+}
+
+int PDC_pair_content(short pair, short * fg, short * bg)
+{
+    t_pdc_context *c = _context();
+    
+    *fg = c->atrtab[pair].f;
+    *bg = c->atrtab[pair].b;
+    return OK;
+}
+
+void PDC_reset_prog_mode(void)
+{
+}
+
+void PDC_reset_shell_mode(void)
+{
+}
+
+int PDC_resize_screen(int nlines, int ncols)
+{
+    return ERR;
+}
+
+void PDC_restore_screen_mode(int i)
+{
+}
+
+void PDC_save_screen_mode(int i)
+{
+}
+
+void PDC_scr_close(void)
+{
+}
+
+void PDC_scr_free(void)
+{
+    // delscreen clears SP once this returns
+    free(SP);
+}
+
+int PDC_scr_open(int argc, char **argv)
+{
+    t_pdc_context *c = _context();
+    int i;
+    
+    SP = calloc(1, sizeof(SCREEN));
+    
+    if (!SP)
+        return ERR;
+    
+    SP->orig_attr = TRUE;
+    SP->orig_fore = COLOR_WHITE;
+    SP->orig_back = -1;
+    
+    for (i = 0; i < 8; i++)
+    {
+        c->color[i][0] = (i & COLOR_RED) ? 680 : 0;
+        c->color[i][1] = (i & COLOR_GREEN) ? 680 : 0;
+        c->color[i][2] = (i & COLOR_BLUE) ? 680 : 0;
+        
+        c->color[i + 8][0] = (i & COLOR_RED) ? 1000 : 250;
+        c->color[i + 8][1] = (i & COLOR_GREEN) ? 1000 : 250;
+        c->color[i + 8][2] = (i & COLOR_BLUE) ? 1000 : 250;
+    }
+    
+    SP->lines = PDC_get_rows();
+    SP->cols = PDC_get_columns();
+    for (i = 0; i < PDC_cols*PDC_rows; i++)
+        c->screen[i] = ' ';
+    
+    return OK;
+}
+
+int PDC_set_blink(bool blinkon)
+{
+    if (pdc_color_started)
+        COLORS = 16;
+    
+    return blinkon ? ERR : OK;
+}
+
+void PDC_set_keyboard_binary(bool on)
+{
+}
+
+const char *PDC_sysname(void)
+{
+    return "Headless";
+}
+
+void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
+{
+    t_pdc_context *c = _context();
+    
+    if (len <= 0)
+        return;
+    
+    memcpy(c->screen + (lineno * PDC_cols) + x, srcp, len * sizeof(chtype));
+}
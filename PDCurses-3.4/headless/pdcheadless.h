@@ -0,0 +1,21 @@
+#ifndef __PDCURSES_HEADLESS__
+#define __PDCURSES_HEADLESS__ 1
+
+/*
+ * the headless port speaks the game side of the cc2dx interface, so a
+ * game written against pdccc2dx.h links against either one. nothing is
+ * drawn: keys come from a file descriptor and the screen stays in memory
+ */
+#include "pdccc2dx.h"
+
+#include <stdio.h>
+
+/* read the bound game's keys from fd (stdin until told otherwise, or
+   the descriptor given to newScreenContext). at end of input every read
+   returns KEY_EXIT and the game is expected to wind down */
+void setHeadlessInput(int fd);
+
+/* write the screen as plain text, one line per row */
+void writeHeadlessScreen(FILE *fp);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * rogue on the headless port: keys come from a script or a file
+ * descriptor, the screen stays in memory and can be written out when
+ * the keys run out.
+ *
+ *	rogue [-i keyfile] [-d fd] [-o screenfile] [rogue arguments]
+ *
+ * "-" reads keys from stdin or writes the screen to stdout.  SEED
+ * in the environment fixes the dungeon.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pdcheadless.h"
+
+int rogue_main(int argc, char **argv);
+
+static FILE *screen_out = NULL;
+
+static void
+write_screen(void)
+{
+    if (screen_out != NULL)
+	writeHeadlessScreen(screen_out);
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-i keyfile] [-d fd] [-o screenfile] [rogue arguments]\n", prog);
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    int opt, fd;
+
+    while ((opt = getopt(argc, argv, "+i:d:o:")) != -1)
+	switch (opt)
+	{
+	    case 'i':
+		if (strcmp(optarg, "-") == 0)
+		    fd = 0;
+		else if ((fd = open(optarg, O_RDONLY)) < 0)
+		{
+		    perror(optarg);
+		    exit(1);
+		}
+		setHeadlessInput(fd);
+		break;
+	    case 'd':
+		setHeadlessInput(atoi(optarg));
+		break;
+	    case 'o':
+		if (strcmp(optarg, "-") == 0)
+		    screen_out = stdout;
+		else if ((screen_out = fopen(optarg, "w")) == NULL)
+		{
+		    perror(optarg);
+		    exit(1);
+		}
+		break;
+	    default:
+		usage(argv[0]);
+	}
+
+    /*
+     * rogue_main() comes back once the game ends or the keys run out,
+     * the screen is written either way
+     */
+    atexit(write_screen);
+    argv[optind - 1] = argv[0];
+    return rogue_main(argc - optind + 1, argv + optind - 1);
+}
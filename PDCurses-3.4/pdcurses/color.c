@@ -94,16 +94,16 @@ RCSID("$Id: color.c,v 1.83 2008/07/13 16:08:18 wmcbrine Exp $")
 #include <stdlib.h>
 #include <string.h>
 
-int COLORS = 0;
-int COLOR_PAIRS = PDC_COLOR_PAIRS;
+PDCTLS int COLORS = 0;
+PDCTLS int COLOR_PAIRS = PDC_COLOR_PAIRS;
 
-bool pdc_color_started = FALSE;
+PDCTLS bool pdc_color_started = FALSE;
 
 /* pair_set[] tracks whether a pair has been set via init_pair() */
 
-static bool pair_set[PDC_COLOR_PAIRS];
-static bool default_colors = FALSE;
-static short first_col = 0;
+static PDCTLS bool pair_set[PDC_COLOR_PAIRS];
+static PDCTLS bool default_colors = FALSE;
+static PDCTLS short first_col = 0;
 
 int start_color(void)
 {
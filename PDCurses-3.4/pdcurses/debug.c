@@ -33,7 +33,7 @@ RCSID("$Id: debug.c,v 1.7 2008/07/13 16:08:18 wmcbrine Exp $")
 #include <sys/types.h>
 #include <time.h>
 
-bool pdc_trace_on = FALSE;
+PDCTLS bool pdc_trace_on = FALSE;
 
 void PDC_debug(const char *fmt, ...)
 {
@@ -84,10 +84,10 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
 #define _INBUFSIZ   512 /* size of terminal input buffer */
 #define NUNGETCH    256 /* max # chars to ungetch() */
 
-static int c_pindex = 0;    /* putter index */
-static int c_gindex = 1;    /* getter index */
-static int c_ungind = 0;    /* ungetch() push index */
-static int c_ungch[NUNGETCH];   /* array of ungotten chars */
+static PDCTLS int c_pindex = 0;    /* putter index */
+static PDCTLS int c_gindex = 1;    /* getter index */
+static PDCTLS int c_ungind = 0;    /* ungetch() push index */
+static PDCTLS int c_ungch[NUNGETCH];   /* array of ungotten chars */
 
 static int _mouse_key(WINDOW *win)
 {
@@ -156,7 +156,7 @@ static int _mouse_key(WINDOW *win)
 
 int wgetch(WINDOW *win)
 {
-    static int buffer[_INBUFSIZ];   /* character buffer */
+    static PDCTLS int buffer[_INBUFSIZ];   /* character buffer */
     int key, waitcount;
 
     PDC_LOG(("wgetch() - called\n"));
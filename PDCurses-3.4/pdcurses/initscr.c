@@ -90,23 +90,23 @@ RCSID("$Id: initscr.c,v 1.114 2008/07/13 16:08:18 wmcbrine Exp $")
 
 #include <stdlib.h>
 
-char ttytype[128];
+PDCTLS char ttytype[128];
 
 const char *_curses_notice = "PDCurses 3.4 - Public Domain 2008";
 
-SCREEN *SP = (SCREEN*)NULL;           /* curses variables */
-WINDOW *curscr = (WINDOW *)NULL;      /* the current screen image */
-WINDOW *stdscr = (WINDOW *)NULL;      /* the default screen window */
-WINDOW *pdc_lastscr = (WINDOW *)NULL; /* the last screen image */
+PDCTLS SCREEN *SP = (SCREEN*)NULL;           /* curses variables */
+PDCTLS WINDOW *curscr = (WINDOW *)NULL;      /* the current screen image */
+PDCTLS WINDOW *stdscr = (WINDOW *)NULL;      /* the default screen window */
+PDCTLS WINDOW *pdc_lastscr = (WINDOW *)NULL; /* the last screen image */
 
-int LINES = 0;                        /* current terminal height */
-int COLS = 0;                         /* current terminal width */
-int TABSIZE = 8;
+PDCTLS int LINES = 0;                        /* current terminal height */
+PDCTLS int COLS = 0;                         /* current terminal width */
+PDCTLS int TABSIZE = 8;
 
-MOUSE_STATUS Mouse_status, pdc_mouse_status;
+PDCTLS MOUSE_STATUS Mouse_status, pdc_mouse_status;
 
-extern RIPPEDOFFLINE linesripped[5];
-extern char linesrippedoff;
+extern PDCTLS RIPPEDOFFLINE linesripped[5];
+extern PDCTLS char linesrippedoff;
 
 WINDOW *Xinitscr(int argc, char *argv[])
 {
@@ -85,10 +85,12 @@ RCSID("$Id: kernel.c,v 1.78 2008/07/15 17:13:26 wmcbrine Exp $")
 
 #include <string.h>
 
-RIPPEDOFFLINE linesripped[5];
-char linesrippedoff = 0;
+PDCTLS RIPPEDOFFLINE linesripped[5];
+PDCTLS char linesrippedoff = 0;
 
-static struct cttyset
+/* per thread like SP, or one game's endwin() restores another's screen */
+
+static PDCTLS struct cttyset
 {
     bool been_set;
     SCREEN saved;
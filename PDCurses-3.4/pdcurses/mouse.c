@@ -151,7 +151,7 @@ RCSID("$Id: mouse.c,v 1.45 2008/07/13 16:08:18 wmcbrine Exp $")
 
 #include <string.h>
 
-static bool ungot = FALSE;
+static PDCTLS bool ungot = FALSE;
 
 int mouse_set(unsigned long mbe)
 {
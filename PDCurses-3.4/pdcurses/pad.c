@@ -70,8 +70,8 @@ RCSID("$Id: pad.c,v 1.50 2008/07/14 12:22:13 wmcbrine Exp $")
 
 /* save values for pechochar() */
 
-static int save_pminrow, save_pmincol;
-static int save_sminrow, save_smincol, save_smaxrow, save_smaxcol;
+static PDCTLS int save_pminrow, save_pmincol;
+static PDCTLS int save_sminrow, save_smincol, save_smaxrow, save_smaxcol;
 
 WINDOW *newpad(int nlines, int ncols)
 {
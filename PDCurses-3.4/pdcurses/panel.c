@@ -126,9 +126,9 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
 #include <panel.h>
 #include <stdlib.h>
 
-PANEL *_bottom_panel = (PANEL *)0;
-PANEL *_top_panel = (PANEL *)0;
-PANEL _stdscr_pseudo_panel = { (WINDOW *)0 };
+PDCTLS PANEL *_bottom_panel = (PANEL *)0;
+PDCTLS PANEL *_top_panel = (PANEL *)0;
+PDCTLS PANEL _stdscr_pseudo_panel = { (WINDOW *)0 };
 
 #ifdef PANEL_DEBUG
 
@@ -85,11 +85,11 @@ RCSID("$Id: slk.c,v 1.61 2008/07/13 16:08:18 wmcbrine Exp $")
 
 enum { LABEL_NORMAL = 8, LABEL_EXTENDED = 10, LABEL_NCURSES_EXTENDED = 12 };
 
-static int label_length = 0;
-static int labels = 0;
-static int label_fmt = 0;
-static int label_line = 0;
-static bool hidden = FALSE;
+static PDCTLS int label_length = 0;
+static PDCTLS int labels = 0;
+static PDCTLS int label_fmt = 0;
+static PDCTLS int label_line = 0;
+static PDCTLS bool hidden = FALSE;
 
 static struct SLK {
     chtype label[32];
@@ -279,7 +279,7 @@ int slk_noutrefresh(void)
 
 char *slk_label(int labnum)
 {
-    static char temp[33];
+    static PDCTLS char temp[33];
 #ifdef PDC_WIDE
     wchar_t *wtemp = slk_wlabel(labnum);
 
@@ -624,7 +624,7 @@ int slk_wset(int labnum, const wchar_t *label, int justify)
 
 wchar_t *slk_wlabel(int labnum)
 {
-    static wchar_t temp[33];
+    static PDCTLS wchar_t temp[33];
     chtype *p;
     int i;
 
@@ -48,7 +48,7 @@ RCSID("$Id: terminfo.c,v 1.37 2008/07/21 12:29:20 wmcbrine Exp $")
 
 #include <term.h>
 
-TERMINAL *cur_term = NULL;
+PDCTLS TERMINAL *cur_term = NULL;
 
 int mvcur(int oldrow, int oldcol, int newrow, int newcol)
 {
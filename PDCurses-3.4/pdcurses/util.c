@@ -84,7 +84,7 @@ RCSID("$Id: util.c,v 1.71 2008/07/13 16:08:18 wmcbrine Exp $")
 
 char *unctrl(chtype c)
 {
-    static char strbuf[3] = {0, 0, 0};
+    static PDCTLS char strbuf[3] = {0, 0, 0};
 
     chtype ic;
 
@@ -164,7 +164,7 @@ int setcchar(cchar_t *wcval, const wchar_t *wch, const attr_t attrs,
 
 wchar_t *wunctrl(cchar_t *wc)
 {
-    static wchar_t strbuf[3] = {0, 0, 0};
+    static PDCTLS wchar_t strbuf[3] = {0, 0, 0};
 
     cchar_t ic;
 
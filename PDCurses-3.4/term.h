@@ -24,12 +24,12 @@ typedef struct
 
 #ifdef PDC_DLL_BUILD
 # ifndef CURSES_LIBRARY
-__declspec(dllimport)  TERMINAL *cur_term;
+__declspec(dllimport)  PDCTLS TERMINAL *cur_term;
 # else
-__declspec(dllexport) extern TERMINAL *cur_term;
+__declspec(dllexport) extern PDCTLS TERMINAL *cur_term;
 # endif
 #else
-extern TERMINAL *cur_term;
+extern PDCTLS TERMINAL *cur_term;
 #endif
 
 int     del_curterm(TERMINAL *);
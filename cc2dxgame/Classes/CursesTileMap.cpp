@@ -7,16 +7,15 @@
 //
 
 #include "CursesTileMap.hpp"
+#include "TerminalGrid.hpp"
 #include "pdccc2dx.h"
 
 extern "C" {
-    bool isScreenDirty();
-    char *getScreenData();
-    t_pdc_color *getScreenColor();
+    unsigned long readScreenFrame(t_pdc_cell *cells, t_pdc_color *palette, unsigned char *things, t_pdc_frame_info *info, t_pdc_damage *damage, int count, unsigned long seen);
+    bool popScreenEvent(t_pdc_event *ev);
+    bool queryScreenSnapshot(t_pdc_snapshot *snap, int ms);
 }
 
-#include "pdccc2dx.h"
-
 USING_NS_CC;
 
 CursesTileMap::CursesTileMap() : TMXTiledMap()
@@ -27,22 +26,192 @@ CursesTileMap::CursesTileMap() : TMXTiledMap()
     }
     remappedTiles = false;
     layer = 0;
+    grid = 0;
+    
+    frameSequence = 0;
+    checkedSequence = 0;
+    memset(frameData, 0, sizeof(frameData));
+    memset(frameCells, 0, sizeof(frameCells));
+    memset(palette, 0, sizeof(palette));
+    memset(frameThings, PDC_THING_NONE, sizeof(frameThings));
+    memset(&frameInfo, -1, sizeof(frameInfo));
+    frameInfo.mode = MapScreen;
+    memset(screenData, 0, sizeof(screenData));
+    
+    clearDamage();
+    growDamage(0, 80);
+}
+
+bool CursesTileMap::syncFrame()
+{
+    // only copies when the game thread has published a newer frame
+    t_pdc_damage damage;
+    unsigned long seq = readScreenFrame(frameCells, (t_pdc_color*)palette, frameThings, (t_pdc_frame_info*)&frameInfo, &damage, 2000, frameSequence);
+    if (seq == frameSequence)
+        return false;
+    frameSequence = seq;
+    
+    // refresh the plain characters of the changed cells only
+    for(int r=0;r<25;r++) {
+        if (damage.firstch[r] == -1)
+            continue;
+        addDamage(r, damage.firstch[r], damage.lastch[r]);
+        for(int c=damage.firstch[r];c<=damage.lastch[r];c++) {
+            frameData[(r*80) + c] = frameCells[(r*80) + c] & PDC_CELL_GLYPH;
+        }
+    }
+
+#ifdef ATROGUE
+    // atrogue publishes no hero, so take the first '@' on the screen
+    const char *hero = (const char*)memchr(frameData, '@', 2000);
+    if (hero) {
+        frameInfo.heroY = (hero - frameData) / 80;
+        frameInfo.heroX = (hero - frameData) % 80;
+    }
+#endif
+    return true;
+}
+
+void CursesTileMap::addDamage(int r, int first, int last)
+{
+    if (damageFirst[r] == -1 || damageFirst[r] > first)
+        damageFirst[r] = first;
+    if (damageLast[r] < last)
+        damageLast[r] = last;
+}
+
+void CursesTileMap::growDamage(int rows, int cols)
+{
+    // widen every damaged span, for tiles that depend on their neighbours;
+    // cols >= 80 with rows 0 marks the whole screen
+    short first[25];
+    short last[25];
+    memcpy(first, damageFirst, sizeof(first));
+    memcpy(last, damageLast, sizeof(last));
+    
+    for(int r=0;r<25;r++) {
+        if (cols >= 80) {
+            addDamage(r, 0, 79);
+            continue;
+        }
+        if (first[r] == -1)
+            continue;
+        for(int rr=std::max(0,r-rows);rr<=std::min(24,r+rows);rr++) {
+            addDamage(rr, std::max(0,first[r]-cols), std::min(79,last[r]+cols));
+        }
+    }
+}
+
+void CursesTileMap::clearDamage()
+{
+    for(int r=0;r<25;r++) {
+        damageFirst[r] = -1;
+        damageLast[r] = -1;
+    }
+}
+
+const char* CursesTileMap::getFrameData()
+{
+    syncFrame();
+    return frameData;
+}
+
+const CursesTileMap::TileCell* CursesTileMap::getFrameCells()
+{
+    syncFrame();
+    return frameCells;
+}
+
+const CursesTileMap::TileColor* CursesTileMap::getPalette()
+{
+    syncFrame();
+    return palette;
+}
+
+const unsigned char* CursesTileMap::getFrameThings()
+{
+    syncFrame();
+    return frameThings;
+}
+
+const CursesTileMap::FrameInfo& CursesTileMap::getFrameInfo()
+{
+    syncFrame();
+    return frameInfo;
+}
+
+bool CursesTileMap::popEvent(ScreenEvent &ev)
+{
+    t_pdc_event e;
+    if (!popScreenEvent(&e))
+        return false;
+    ev.type = e.type;
+    ev.kind = e.kind;
+    ev.stats.level = e.stats.level;
+    ev.stats.gold = e.stats.gold;
+    ev.stats.hp = e.stats.hp;
+    ev.stats.hpMax = e.stats.hp_max;
+    ev.stats.str = e.stats.str;
+    ev.stats.strMax = e.stats.str_max;
+    ev.stats.arm = e.stats.arm;
+    ev.stats.expLevel = e.stats.exp_level;
+    ev.stats.exp = e.stats.exp;
+    ev.stats.hunger = e.stats.hunger;
+    ev.text = e.text;
+    return true;
+}
+
+static void copyItems(std::vector<CursesTileMap::GameItem> &items, const t_pdc_item *src, int count)
+{
+    items.resize(count);
+    for(int i=0;i<count;i++) {
+        items[i].letter = src[i].letter;
+        items[i].type = src[i].type;
+        items[i].which = src[i].which;
+        items[i].count = src[i].count;
+        items[i].flags = src[i].flags;
+        items[i].name = src[i].name;
+    }
 }
 
-CursesTileMap::TileColor* CursesTileMap::getScreenColor()
+bool CursesTileMap::querySnapshot(GameSnapshot &snap, int ms)
 {
-    return (CursesTileMap::TileColor*)(::getScreenColor());
+    // filled in by the game thread, only ever asked for from this one
+    static t_pdc_snapshot s;
+    if (!queryScreenSnapshot(&s, ms))
+        return false;
+    
+    snap.level = s.stats.level;
+    snap.gold = s.stats.gold;
+    snap.hp = s.stats.hp;
+    snap.hpMax = s.stats.hp_max;
+    snap.str = s.stats.str;
+    snap.strMax = s.stats.str_max;
+    snap.arm = s.stats.arm;
+    snap.expLevel = s.stats.exp_level;
+    snap.exp = s.stats.exp;
+    snap.picking = s.picking != 0;
+    copyItems(snap.items, s.items, s.item_count);
+    copyItems(snap.discoveries, s.discoveries, s.discovery_count);
+    return true;
 }
 
 bool CursesTileMap::isScreenDirty()
 {
-    return ::isScreenDirty();
+    // other readers may have pulled the frame already, compare against
+    // the generation this map last reported
+    syncFrame();
+    if (checkedSequence == frameSequence)
+        return false;
+    checkedSequence = frameSequence;
+    return true;
 }
 
 char* CursesTileMap::getScreenData(bool fresh)
 {
+    // screenData is a scratch copy callers may rewrite, frameData stays intact
     if (fresh)
-        memcpy(screenData, ::getScreenData(), 2000);
+        memcpy(screenData, getFrameData(), 2000);
     return screenData;
 }
 
@@ -75,52 +244,50 @@ void CursesTileMap::draw(char *data)
         layer = getLayer("Background");
         layer->getTexture()->setAntiAliasTexParameters();
         layer->getTexture()->setAliasTexParameters();
+        
+        // the grid draws the layer's tiles in one batch, the layer itself
+        // is kept for its tileset and opacity
+        grid = TerminalGrid::createWithLayer(layer);
+        addChild(grid, layer->getLocalZOrder());
+        layer->setVisible(false);
+        growDamage(0, 80);
     }
     
-    TileColor *colors = getScreenColor();
-    
     if (_terminalSize.width == 0 || _terminalSize.height == 0) {
         setTerminalSize(Size(getmaxx(curscr), getmaxy(curscr)));
     }
     
     int tw = _terminalSize.width;
     
-    for(int r=0;r<_terminalSize.height;r++) {
+    for(int r=0;r<_terminalSize.height && r<25;r++) {
+        
+        if (damageFirst[r] == -1)
+            continue;
+        
+        int last = std::min((int)damageLast[r], tw - 1);
         
-        for(int c=0;c<_terminalSize.width;c++) {
+        for(int c=damageFirst[r];c<=last;c++) {
                         
             char ch = data[(r*tw) + c];
             int chM = tilesetMap[ch];
-            TileColor clr = colors[(r*tw) + c];
+            TileColor clr = palette[PDC_CELL_FG(frameCells[(r*tw) + c])];
             
             if (ch == -1 || ch == ' ')
                 ch = 0;
             
-            if (layer->getTileGIDAt(Vec2(c,r)) == chM + 1)
-                continue;
-            
-            auto tile = layer->getTileAt(Vec2(c,r));
-            if (!tile)
-                continue;
-            
-            tile->setVisible(chM != 0);
-            tile->setScale(1.008, 1.008);
-            layer->setTileGID(chM + 1, Vec2(c,r));
-            
-            tile->setOpacity(layer->getOpacity());
-            
             Color3B clrMap = colorMap[ch];
-            if (clrMap != Color3B::BLACK) {
-                tile->setColor(clrMap);
-            } else {
+            if (clrMap == Color3B::BLACK) {
                 if (clr.r == 0 && clr.g == 0 && clr.b == 0)
-                    tile->setColor(Color3B(0xff,0xff,0xff));
+                    clrMap = Color3B(0xff,0xff,0xff);
                 else
-                    tile->setColor(Color3B(clr.r, clr.g, clr.b));
+                    clrMap = Color3B(clr.r, clr.g, clr.b);
             }
+            
+            grid->setTile(c, r, chM + 1, shadeTile(r, c, clrMap), layer->getOpacity(), chM != 0);
         }
     }
-
+    
+    clearDamage();
 }
 
 void CursesTileMap::positionAndScale(MapAlign hAlign, MapAlign vAlign, float scale)
@@ -181,7 +348,7 @@ void CursesTileMap::positionAndScale(MapAlign hAlign, MapAlign vAlign, float sca
 std::string CursesTileMap::getStringAtLine(int l)
 {
     int tw  =_terminalSize.width;
-    char *data = getScreenData();
+    const char *data = getFrameData();
     data += (l * tw);
     
     int end = tw;
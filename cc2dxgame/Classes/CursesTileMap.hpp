@@ -11,6 +11,8 @@
 
 #include "cocos2d.h"
 
+class TerminalGrid;
+
 class CursesTileMap : public cocos2d::TMXTiledMap
 {
 public:
@@ -30,19 +32,118 @@ public:
         unsigned short b;
     } TileColor;
     
+    // mirrors t_pdc_cell, glyph in the low 16 bits then fg and bg index
+    typedef unsigned int TileCell;
+    
+    // mirrors t_pdc_frame_info, -1 for anything the game has not set
+    typedef struct {
+        short heroY;
+        short heroX;
+        short roomTop;
+        short roomLeft;
+        short roomBottom;
+        short roomRight;
+        short mode;
+    } FrameInfo;
+    
+    enum ScreenMode {
+        MapScreen = 0,
+        MenuScreen,
+        EndScreen
+    };
+    
+    // mirrors PDC_EVENT_* and PDC_PROMPT_*
+    enum EventType {
+        MessageEvent = 1,
+        PromptEvent,
+        StatusEvent
+    };
+    
+    enum PromptKind {
+        MorePrompt = 1,
+        NamePrompt,
+        IdentifyPrompt,
+        ItemPrompt,
+        HandPrompt
+    };
+    
+    // mirrors t_pdc_stats, hunger is rogue's hungry_state (0 to 3)
+    typedef struct {
+        int level;
+        int gold;
+        int hp;
+        int hpMax;
+        int str;
+        int strMax;
+        int arm;
+        int expLevel;
+        int exp;
+        int hunger;
+    } GameStats;
+    
+    typedef struct {
+        int type;
+        int kind;
+        GameStats stats;
+        std::string text;
+    } ScreenEvent;
+    
+    // mirrors PDC_ITEM_*
+    enum ItemFlags {
+        ItemWielded = 0x01,
+        ItemWorn = 0x02,
+        ItemLeftHand = 0x04,
+        ItemRightHand = 0x08,
+        ItemKnown = 0x10,
+        ItemPickable = 0x20
+    };
+    
+    // mirrors t_pdc_item, type is the object's glyph
+    typedef struct {
+        char letter;
+        char type;
+        int which;
+        int count;
+        int flags;
+        std::string name;
+    } GameItem;
+    
+    // mirrors t_pdc_snapshot
+    typedef struct {
+        int level;
+        int gold;
+        int hp;
+        int hpMax;
+        int str;
+        int strMax;
+        int arm;
+        int expLevel;
+        int exp;
+        bool picking;
+        std::vector<GameItem> items;
+        std::vector<GameItem> discoveries;
+    } GameSnapshot;
+    
     CursesTileMap();
     virtual void update(float delta);
     virtual void draw(char *);
+    virtual cocos2d::Color3B shadeTile(int r, int c, const cocos2d::Color3B &color) { return color; }
     
     bool isScreenDirty();
     char *getScreenData(bool fresh = true);
-    TileColor *getScreenColor();
+    const TileCell *getFrameCells();
+    const TileColor *getPalette();
+    const unsigned char *getFrameThings();
+    const FrameInfo &getFrameInfo();
+    bool popEvent(ScreenEvent &ev);
+    bool querySnapshot(GameSnapshot &snap, int ms = 100);
     
     void setTerminalSize(cocos2d::Size sz);
     int width() { return _terminalSize.width; }
     int height() { return _terminalSize.height; }
     void positionAndScale(MapAlign hAlign, MapAlign vAligns, float scale);
     
+    const char *getFrameData();
     std::string getStringAtLine(int l);
     void clearAtLine(int l);
     
@@ -51,7 +152,23 @@ public:
 
 protected:
     
+    bool syncFrame();
+    void addDamage(int r, int first, int last);
+    void growDamage(int rows, int cols);
+    void clearDamage();
+    
     char screenData[2000];
+    char frameData[2000];
+    TileCell frameCells[2000];
+    TileColor palette[16];
+    unsigned char frameThings[2000];
+    FrameInfo frameInfo;
+    unsigned long frameSequence;
+    unsigned long checkedSequence;
+    
+    // cells changed since the last draw, -1 for untouched rows
+    short damageFirst[25];
+    short damageLast[25];
     int tilesetMap[256];
     cocos2d::Color3B colorMap[256];
     bool remappedTiles;
@@ -59,6 +176,7 @@ protected:
 protected:
     cocos2d::Size _terminalSize;
     cocos2d::TMXLayer *layer;
+    TerminalGrid *grid;
 };
 
 #endif /* CursesTileMap_hpp */
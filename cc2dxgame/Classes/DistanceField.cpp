@@ -0,0 +1,134 @@
+//
+//  DistanceField.cpp
+//  cc2dxgame
+//
+//
+
+#include "DistanceField.hpp"
+#include <string.h>
+
+DistanceField::DistanceField()
+{
+    memset(dist, 0xff, sizeof(dist));
+    memset(parent, 0xff, sizeof(parent));
+    origin = -1;
+    generation = 0;
+    valid = false;
+    
+    pending = false;
+    pendingOrigin = -1;
+    pendingGeneration = 0;
+    floodedGeneration = 0;
+    floodedValid = false;
+    done = false;
+    doneOrigin = -1;
+    doneGeneration = 0;
+    quit = false;
+}
+
+DistanceField::~DistanceField()
+{
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+}
+
+void DistanceField::request(const unsigned char *walk, int cell, unsigned long gen)
+{
+    // the worker only starts once there is something to flood
+    if (!worker.joinable())
+        worker = std::thread(&DistanceField::run, this);
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(pendingWalk, walk, sizeof(pendingWalk));
+        pendingOrigin = cell;
+        pendingGeneration = gen;
+        pending = true;
+    }
+    wake.notify_one();
+}
+
+bool DistanceField::poll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!done)
+        return false;
+    
+    memcpy(dist, doneDist, sizeof(dist));
+    memcpy(parent, doneParent, sizeof(parent));
+    origin = doneOrigin;
+    generation = doneGeneration;
+    valid = true;
+    done = false;
+    return true;
+}
+
+bool DistanceField::isCurrent(int cell, unsigned long gen)
+{
+    return valid && origin == cell && generation == gen;
+}
+
+int DistanceField::pathTo(int cell, short *path, int maxPath, int *length, float *cost)
+{
+    *length = 0;
+    *cost = 0;
+    
+    if (!valid || cell < 0 || cell >= GridPather::Cells)
+        return GridPather::NO_SOLUTION;
+    if (cell == origin)
+        return GridPather::START_END_SAME;
+    if (!isReachable(cell))
+        return GridPather::NO_SOLUTION;
+    
+    int count = 0;
+    for(int c=cell;c!=-1;c=parent[c])
+        count++;
+    if (count > maxPath)
+        return GridPather::NO_SOLUTION;
+    
+    int i = count;
+    for(int c=cell;c!=-1;c=parent[c])
+        path[--i] = c;
+    
+    *length = count;
+    *cost = dist[cell] / 2.0f;
+    return GridPather::SOLVED;
+}
+
+void DistanceField::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;) {
+        wake.wait(lock, [this] { return pending || quit; });
+        if (quit)
+            return;
+        
+        // take the request and flood without holding the lock, the ui
+        // thread may queue the next one meanwhile
+        unsigned long gen = pendingGeneration;
+        int cell = pendingOrigin;
+        bool rebuild = !floodedValid || floodedGeneration != gen;
+        if (rebuild)
+            pather.setWalkMap(pendingWalk);
+        pending = false;
+        lock.unlock();
+        
+        floodedGeneration = gen;
+        floodedValid = true;
+        
+        pather.flood(cell, floodDist, floodParent);
+        
+        lock.lock();
+        memcpy(doneDist, floodDist, sizeof(doneDist));
+        memcpy(doneParent, floodParent, sizeof(doneParent));
+        doneOrigin = cell;
+        doneGeneration = gen;
+        done = true;
+    }
+}
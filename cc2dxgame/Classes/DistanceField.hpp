@@ -0,0 +1,76 @@
+//
+//  DistanceField.hpp
+//  cc2dxgame
+//
+//
+
+#ifndef DistanceField_hpp
+#define DistanceField_hpp
+
+#include "GridPather.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// distance from the hero to every cell of the map, flooded on a worker
+// thread whenever the hero or the walkable cells change. once it is in,
+// any tap is answered by walking the parents back, and the same field
+// tells which cells can be reached at all
+class DistanceField
+{
+public:
+    
+    DistanceField();
+    ~DistanceField();
+    
+    // ui thread: flood from 'origin' over 'walk', replaces anything
+    // still waiting
+    void request(const unsigned char *walk, int origin, unsigned long generation);
+    
+    // ui thread: pick up a finished flood, true when it is a new one
+    bool poll();
+    
+    // the field picked up last matches this origin and walk generation
+    bool isCurrent(int origin, unsigned long generation);
+    
+    bool isReachable(int cell) { return dist[cell] != GridPather::Unreachable; }
+    int getDistance(int cell) { return dist[cell]; }
+    
+    // same as GridPather::solve, but only follows the parents
+    int pathTo(int cell, short *path, int maxPath, int *length, float *cost);
+    
+private:
+    
+    void run();
+    
+    // picked up by the ui thread
+    unsigned short dist[GridPather::Cells];
+    short parent[GridPather::Cells];
+    int origin;
+    unsigned long generation;
+    bool valid;
+    
+    // worker side, handed over under the mutex
+    GridPather pather;
+    unsigned char pendingWalk[GridPather::Cells];
+    int pendingOrigin;
+    unsigned long pendingGeneration;
+    bool pending;
+    unsigned long floodedGeneration;
+    bool floodedValid;
+    unsigned short floodDist[GridPather::Cells];
+    short floodParent[GridPather::Cells];
+    
+    unsigned short doneDist[GridPather::Cells];
+    short doneParent[GridPather::Cells];
+    int doneOrigin;
+    unsigned long doneGeneration;
+    bool done;
+    
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit;
+};
+
+#endif /* DistanceField_hpp */
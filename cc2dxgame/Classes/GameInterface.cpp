@@ -10,10 +10,11 @@
 #include "GraphicsTileMap.hpp"
 #include "ui/CocosGUI.h"
 
-#include "micropather.h"
 
 extern "C" {
     void pushKey(int k);
+    void pushTravel(int y, int x);
+    bool waitInputIdle(int ms);
 }
 
 USING_NS_CC;
@@ -23,7 +24,16 @@ USING_NS_CC;
 
 #define MESSAGE_FADE_DELAY 1.5f
 #define FRAME_OPACITY 220
-#define PUSH_KEY_WAIT 5
+#define INPUT_IDLE_TIMEOUT 100
+#define MAX_ITEM_TEXT 128
+#define PICK_RETRY_FRAMES 3
+
+// pushed keys are queued, so only wait when the screen is read back right
+// after: until the game has consumed them and asks for the next one
+static void waitForGame()
+{
+    waitInputIdle(INPUT_IDLE_TIMEOUT);
+}
 
 GameInterface::GameInterface(int w, int h)
 {
@@ -54,19 +64,23 @@ GameInterface::GameInterface(int w, int h)
     this->addChild(dungeon);
     this->addChild(pathMap);
     
-    statsLabel = createLabel(" ");
-    statsLabel->setAnchorPoint(Vec2(0,0));
-    statsLabel->setPosition(Vec2(20,4));
+    statsGap = createLabel("  ")->getContentSize().width;
     
     auto hudBg = ui::Scale9Sprite::create("frame.png");
-    hudBg->addChild(statsLabel);
-    hudBg->setContentSize(Size(winSize.width - 20, statsLabel->getContentSize().height * 1.2f ));
+    for(int i=0;i<StatsFieldCount;i++) {
+        statsFields[i] = createLabel(" ");
+        statsFields[i]->setAnchorPoint(Vec2(0,0));
+        statsFields[i]->setPosition(Vec2(20,4));
+        statsFields[i]->setTextColor(Color4B(0x0,0x0,0x0,0xff));
+        hudBg->addChild(statsFields[i]);
+    }
+    float hudHeight = statsFields[0]->getContentSize().height * 1.2f;
+    hudBg->setContentSize(Size(winSize.width - 20, hudHeight));
     hudBg->setAnchorPoint(Vec2(0,1));
     hudBg->setPosition(Vec2(origin.x + 10,origin.y + winSize.height - 10));
     hudBg->getTexture()->setAliasTexParameters();
     hudBg->setOpacity(FRAME_OPACITY);
     hudBg->setColor(Color3B::WHITE);
-    statsLabel->setTextColor(Color4B(0x0,0x0,0x0,0xff));
     this->addChild(hudBg);
     
     hudFrame = hudBg;
@@ -77,7 +91,7 @@ GameInterface::GameInterface(int w, int h)
     
     messageLabelFrame = ui::Scale9Sprite::create("frame.png");
     messageLabelFrame->setAnchorPoint(Vec2(0,0));
-    messageLabelFrame->setContentSize(Size(winSize.width - 20, statsLabel->getContentSize().height * 1.2f ));
+    messageLabelFrame->setContentSize(Size(winSize.width - 20, hudHeight));
     messageLabelFrame->setOpacity(FRAME_OPACITY);
     messageLabelFrame->setColor(Color3B(0x20,0x20,0x20));
     this->addChild(messageLabelFrame);
@@ -86,6 +100,10 @@ GameInterface::GameInterface(int w, int h)
     // ROGUE
     messageLine = 0;
     statsLine = 23;
+    currentLevel = 0;
+    pendingPrompt = 0;
+    pickRetry = 0;
+    statsShown = false;
     
 #ifdef ATROGUE
     messageLine = 23;
@@ -189,7 +207,7 @@ void GameInterface::updateZoom()
     };
     zoomIndex = zoomIndex % (int)(sizeof(ff) / sizeof(float));
     dungeon->positionAndScale(CursesTileMap::MapAlign::Left, CursesTileMap::MapAlign::Top, 2.0f * scaleFactor * ff[zoomIndex]);
-    dungeon->centerAt();
+    dungeon->centerAt(true);
     
     scaleAndPositionPathMap(dungeon);
 }
@@ -214,11 +232,8 @@ cocos2d::Label* GameInterface::createLabel(std::string text)
 
 void GameInterface::cancelPendingCommand()
 {
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
     pushKey((int)EventKeyboard::KeyCode::KEY_ESCAPE, false, false);
-    std::this_thread::sleep_for( duration );
     pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-    std::this_thread::sleep_for( duration );
 }
 
 ui::Button* GameInterface::createButton(std::string text, int tag)
@@ -273,7 +288,6 @@ ui::Button* GameInterface::createButton(std::string text, int tag)
 
 void GameInterface::buttonCallback(cocos2d::Ref* pSender)
 {
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
     ui::Button *self = (ui::Button*)pSender;
 
     if (messageFrame->isVisible()) {
@@ -294,12 +308,10 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
         case (int)ButtonCommand::IdentifyTrap:
             menuFrame->setVisible(false);
             ::pushKey('^');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Identify:
             menuFrame->setVisible(false);
             ::pushKey('/');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Help:
             menuFrame->setVisible(false);
@@ -308,18 +320,20 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
         case (int)ButtonCommand::Version:
             menuFrame->setVisible(false);
             ::pushKey('v');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Cancel:
             menuFrame->setVisible(false);
             cancelPendingCommand();
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Zoom:
             menuFrame->setVisible(false);
             zoomIndex++;
             updateZoom();
             break;
+        case (int)ButtonCommand::Explore:
+            menuFrame->setVisible(false);
+            explore();
+            break;
         case (int)ButtonCommand::ToggleGraphics:
         {
             menuFrame->setVisible(false);
@@ -348,22 +362,18 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
         case (int)ButtonCommand::Search:
             cancelPendingCommand();
             ::pushKey('s');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Rest:
             cancelPendingCommand();
             pushKey((int)EventKeyboard::KeyCode::KEY_PERIOD, false, false);
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Up:
             cancelPendingCommand();
             pushKey((int)EventKeyboard::KeyCode::KEY_COMMA, true, false);
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Down:
             cancelPendingCommand();
             pushKey((int)EventKeyboard::KeyCode::KEY_PERIOD, true, false);
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Map:
             showMap();
@@ -388,27 +398,22 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
         case (int)ButtonCommand::Zap:
             menuFrame->setVisible(false);
             ::pushKey('z');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Throw:
             menuFrame->setVisible(false);
             ::pushKey('t');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Fight:
             menuFrame->setVisible(false);
             ::pushKey('f');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::Move:
             menuFrame->setVisible(false);
             ::pushKey('m');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::PickUp:
             menuFrame->setVisible(false);
             ::pushKey(',');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::InputString:
         {
@@ -428,12 +433,10 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
         case (int)ButtonCommand::TakeoffArmour:
             menuFrame->setVisible(false);
             ::pushKey('T');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::RemoveRing:
             menuFrame->setVisible(false);
             ::pushKey('R');
-            std::this_thread::sleep_for( duration );
             break;
         case (int)ButtonCommand::PutOnRing:
             showInventorySelect('P');
@@ -466,7 +469,6 @@ void GameInterface::buttonCallback(cocos2d::Ref* pSender)
             }
             
             ::pushKey(ch);
-            std::this_thread::sleep_for( duration );
         }
             break;
         default:
@@ -480,11 +482,31 @@ void GameInterface::update(float delta)
     if (isDeadMode())
         return;
     
+    // drained every frame whatever is on the screen, so the ring never
+    // fills up behind a menu and the hud comes back up to date
+    consumeEvents();
+    
+    // an item prompt the game was too busy to describe, given up on after
+    // a few frames since every try can wait out the query timeout
+    if (pickRetry > 0 && !menuFrame->isVisible()) {
+        pickRetry--;
+        if (showPickableItems())
+            pickRetry = 0;
+    }
+    
 //    sleep.update(delta);
     consumePath();
     
-    if (!dungeon->isScreenDirty())
+    dungeon->updateCamera(delta);
+    if (showGraphics && pathMap->isVisible())
+        scaleAndPositionPathMap(dungeon);
+    
+    if (!dungeon->isScreenDirty()) {
+        // a flood that came in since the last frame only changes shading
+        if (dungeon->pollDistanceField())
+            dungeon->draw(dungeon->getScreenData(false));
         return;
+    }
     
     pathMap->setVisible(false);
     
@@ -492,38 +514,26 @@ void GameInterface::update(float delta)
         return;
     }
     
-    // draw HUD
-    std::string message = dungeon->getStringAtLine(messageLine);
-    std::string stats = dungeon->getStringAtLine(statsLine);
+#ifdef ATROGUE
+    scrapeHud();
+#endif
     
-    waitingForSpace = (message.find("--More--") != std::string::npos);
-    waitingForString = (message.find("call it?") != std::string::npos);
-    waitingForIdentify = (message.find("identified?") != std::string::npos);
-
-    if (waitingForString) {
-        showKeyboard();
-    }
+    // act on the prompt the game is waiting on, once
+    int prompt = pendingPrompt;
+    pendingPrompt = 0;
     
     char *data = dungeon->getScreenData();
     dungeon->clearAtLine(messageLine);
     dungeon->clearAtLine(statsLine);
+    dungeon->updateWalkMap(data);
+    dungeon->requestDistanceField();
+    dungeon->pollDistanceField();
     
-    statsLabel->setString(stats);
-    
-    if (message.length() > 0) {
-        messageLabel->setString(message);
-        messageLabel->stopAllActions();
-        messageLabel->setVisible(true);
-        messageLabel->setOpacity(255);
-    } else if (messageLabel->getOpacity() == 255) {
-        auto f = FadeOut::create(MESSAGE_FADE_DELAY);
-        messageLabel->runAction(f);
-    }
-    
-//    CursesTileMap::TileColor tc = dungeon->getScreenColor()[0];
-//    statsLabel->setColor(Color3B(tc.r, tc.g, tc.b));
+//    CursesTileMap::TileColor tc = dungeon->getPalette()[PDC_CELL_FG(dungeon->getFrameCells()[0])];
 //    messageLabel->setColor(Color3B(tc.r, tc.g, tc.b));
-    statsLabel->setColor(Color3B::WHITE);
+    for(int i=0;i<StatsFieldCount;i++) {
+        statsFields[i]->setColor(Color3B::WHITE);
+    }
     messageLabel->setColor(Color3B::WHITE);
 
     // draw the dungeon
@@ -536,15 +546,14 @@ void GameInterface::update(float delta)
     
     scaleAndPositionPathMap(showGraphics ? dungeon : curses);
     
-    if (message.find("Which") != std::string::npos &&
-        message.find("(* for list)") != std::string::npos) {
+    if (prompt == CursesTileMap::ItemPrompt) {
         if (!menuFrame->isVisible()) {
             showInventorySelect(0);
             return;
         }
     }
     
-    if ( message.find("hand or right") != std::string::npos ) {
+    if (prompt == CursesTileMap::HandPrompt) {
         Command commands[] = {
             { InventorySelect, "Left" },
             { InventorySelect, "Right" },
@@ -669,25 +678,175 @@ int GameInterface::mapKey(int k, bool shiftPressed, bool controlPressed)
     return -1;
 }
 
+void GameInterface::consumeEvents()
+{
+    // the game reports messages, prompts and stats as they happen, so the
+    // labels only change when there is something new
+    CursesTileMap::ScreenEvent ev;
+    while (dungeon->popEvent(ev)) {
+        switch (ev.type) {
+            case CursesTileMap::MessageEvent:
+            {
+                waitingForSpace = false;
+                waitingForString = false;
+                waitingForIdentify = false;
+                pendingPrompt = 0;
+                pickRetry = 0;
+                
+                showHudMessage(ev.text);
+            }
+                break;
+            case CursesTileMap::PromptEvent:
+                pendingPrompt = ev.kind;
+                if (ev.kind == CursesTileMap::MorePrompt) {
+                    waitingForSpace = true;
+                    messageLabel->setString(messageLabel->getString() + "--More--");
+                } else if (ev.kind == CursesTileMap::NamePrompt) {
+                    waitingForString = true;
+                    showKeyboard();
+                } else if (ev.kind == CursesTileMap::IdentifyPrompt) {
+                    waitingForIdentify = true;
+                }
+                break;
+            case CursesTileMap::StatusEvent:
+            {
+                // a new level, nothing on it has been visited
+                if (ev.stats.level != currentLevel) {
+                    currentLevel = ev.stats.level;
+                    dungeon->clearVisited();
+                }
+                
+                showStats(ev.stats);
+            }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void GameInterface::showHudMessage(const std::string &message)
+{
+    if (message.length() > 0) {
+        messageLabel->setString(message);
+        messageLabel->stopAllActions();
+        messageLabel->setVisible(true);
+        messageLabel->setOpacity(255);
+    } else if (messageLabel->getOpacity() == 255) {
+        auto f = FadeOut::create(MESSAGE_FADE_DELAY);
+        messageLabel->runAction(f);
+    }
+}
+
+#ifdef ATROGUE
+void GameInterface::scrapeHud()
+{
+    // atrogue sends no events, so read the message and stats lines back
+    // off the screen the way every build used to
+    std::string message = dungeon->getStringAtLine(messageLine);
+    std::string stats = dungeon->getStringAtLine(statsLine);
+    
+    waitingForSpace = (message.find("--More--") != std::string::npos);
+    waitingForString = (message.find("call it?") != std::string::npos);
+    waitingForIdentify = (message.find("identified?") != std::string::npos);
+    
+    if (waitingForString) {
+        showKeyboard();
+    }
+    
+    pendingPrompt = 0;
+    if (message.find("Which") != std::string::npos &&
+        message.find("(* for list)") != std::string::npos) {
+        pendingPrompt = CursesTileMap::ItemPrompt;
+    } else if (message.find("hand or right") != std::string::npos) {
+        pendingPrompt = CursesTileMap::HandPrompt;
+    }
+    
+    showHudMessage(message);
+    
+    // the whole line goes in the first field, there are no numbers to split
+    statsFields[0]->setString(stats);
+    for(int i=1;i<StatsFieldCount;i++) {
+        statsFields[i]->setString("");
+    }
+}
+#endif
+
+void GameInterface::showStats(const CursesTileMap::GameStats &st)
+{
+    // only the fields whose numbers moved get new text, and the fields
+    // after one only move along when it came out a different width
+    static const char *hungerNames[] = { "", "Hungry", "Weak", "Faint" };
+    const CursesTileMap::GameStats &was = shownStats;
+    bool changed[StatsFieldCount];
+    char text[StatsFieldCount][32];
+    
+    changed[0] = !statsShown || st.level != was.level;
+    changed[1] = !statsShown || st.gold != was.gold;
+    changed[2] = !statsShown || st.hp != was.hp || st.hpMax != was.hpMax;
+    changed[3] = !statsShown || st.str != was.str || st.strMax != was.strMax;
+    changed[4] = !statsShown || st.arm != was.arm;
+    changed[5] = !statsShown || st.expLevel != was.expLevel || st.exp != was.exp;
+    changed[6] = !statsShown || st.hunger != was.hunger;
+    
+    snprintf(text[0], sizeof(text[0]), "Level: %d", st.level);
+    snprintf(text[1], sizeof(text[1]), "Gold: %d", st.gold);
+    snprintf(text[2], sizeof(text[2]), "Hp: %d(%d)", st.hp, st.hpMax);
+    snprintf(text[3], sizeof(text[3]), "Str: %d(%d)", st.str, st.strMax);
+    snprintf(text[4], sizeof(text[4]), "Arm: %d", st.arm);
+    snprintf(text[5], sizeof(text[5]), "Exp: %d/%d", st.expLevel, st.exp);
+    snprintf(text[6], sizeof(text[6]), "%s",
+             st.hunger >= 0 && st.hunger <= 3 ? hungerNames[st.hunger] : "");
+    
+    int relayout = StatsFieldCount;
+    for(int i=0;i<StatsFieldCount;i++) {
+        if (!changed[i])
+            continue;
+        float width = statsFields[i]->getContentSize().width;
+        statsFields[i]->setString(text[i]);
+        if (relayout > i + 1 && statsFields[i]->getContentSize().width != width)
+            relayout = i + 1;
+    }
+    
+    if (relayout < StatsFieldCount) {
+        Label *prev = statsFields[relayout - 1];
+        float x = prev->getPositionX() + prev->getContentSize().width + statsGap;
+        for(int i=relayout;i<StatsFieldCount;i++) {
+            statsFields[i]->setPositionX(x);
+            x += statsFields[i]->getContentSize().width + statsGap;
+        }
+    }
+    
+    shownStats = st;
+    statsShown = true;
+}
+
 bool GameInterface::isDungeon()
 {
+#ifdef ATROGUE
+    // atrogue publishes no hero or screen mode, so look for the '@' on the
+    // screen: a tombstone has a second one three cells along, and the
+    // inventory and discoveries lists are followed by "print"
     char *data = dungeon->getScreenData();
     for(int i=0;i<80*25;i++) {
         if (data[i] == '@') {
-            std::string str(data+i+1, 40);
-            if (data[i+4] == '@') {
+            if (i + 4 < 80*25 && data[i+4] == '@') {
                 deadMode();
                 return false;
             }
-            //fprintf(stdout, "%s\n", str.c_str());
-            if (str.find("print") == std::string::npos) {
-                return true;
-            } else {
-                return false;
-            }
+            std::string str(data+i+1, std::min(40, 80*25 - i - 1));
+            return str.find("print") == std::string::npos;
         }
     }
     return false;
+#else
+    const CursesTileMap::FrameInfo &info = dungeon->getFrameInfo();
+    if (info.mode == CursesTileMap::EndScreen) {
+        deadMode();
+        return false;
+    }
+    return info.mode == CursesTileMap::MapScreen && info.heroY >= 0;
+#endif
 }
 
 void GameInterface::press(float x, float y)
@@ -714,51 +873,70 @@ void GameInterface::showPlayerInfo()
     
     std::string player;
     
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
-    
-    // press ) to query weapon
+#ifdef ATROGUE
+    // atrogue answers no queries, ask with its own keys and read the
+    // answers off the message line
     pushKey('L', true, false);
-    std::this_thread::sleep_for( duration );
-    
+    waitForGame();
     player += dungeon->getStringAtLine(messageLine) + "\n";
-//    fprintf(stdout, "%s\n", dungeon->getStringAtLine(messageLine).c_str());
     pushKey(';', false, false);
-    std::this_thread::sleep_for( duration );
     
-    // press ] to query armor
     pushKey('y', false, false);
-    std::this_thread::sleep_for( duration );
-//    fprintf(stdout, "%s\n", dungeon->getStringAtLine(messageLine).c_str());
+    waitForGame();
     player += dungeon->getStringAtLine(messageLine) + "\n";
     pushKey(';', false, false);
-    std::this_thread::sleep_for( duration );
     
-    // press = to query rings
     pushKey('Y', false, false);
-    std::this_thread::sleep_for( duration );
-//    fprintf(stdout, "%s\n", dungeon->getStringAtLine(messageLine).c_str());
+    waitForGame();
     player += dungeon->getStringAtLine(messageLine) + "\n";
-    
     pushKey(';', false, false);
-    std::this_thread::sleep_for( duration );
-//    fprintf(stdout, "%s\n", dungeon->getStringAtLine(messageLine).c_str());
+    waitForGame();
     player += dungeon->getStringAtLine(messageLine);
     pushKey(';', false, false);
-    std::this_thread::sleep_for( duration );
+#else
+    // the game is busy, the player can ask again
+    CursesTileMap::GameSnapshot snap;
+    if (!dungeon->querySnapshot(snap))
+        return;
+    
+    char buf[MAX_ITEM_TEXT];
+    snprintf(buf, sizeof(buf), "Level: %d  Gold: %d  Hp: %d(%d)  Str: %d(%d)  Arm: %d  Exp: %d/%d",
+             snap.level, snap.gold, snap.hp, snap.hpMax, snap.str, snap.strMax,
+             snap.arm, snap.expLevel, snap.exp);
+    player = buf;
+    
+    std::string weapon = "\nYou are empty handed";
+    std::string armor = "\nYou are wearing nothing";
+    std::string rings;
+    for(size_t i=0;i<snap.items.size();i++) {
+        const CursesTileMap::GameItem &item = snap.items[i];
+        if (item.flags & CursesTileMap::ItemWielded)
+            weapon = "\n" + getItemText(item);
+        if (item.flags & CursesTileMap::ItemWorn)
+            armor = "\n" + getItemText(item);
+        if (item.flags & (CursesTileMap::ItemLeftHand | CursesTileMap::ItemRightHand))
+            rings += "\n" + getItemText(item);
+    }
+    if (rings.length() == 0)
+        rings = "\nYou are not wearing any rings";
+    player += weapon + armor + rings;
+#endif
     
     showMessage(player);
 }
 
 void GameInterface::showDiscoveries()
 {
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
     menuFrame->setVisible(false);
+    
+    std::string message;
+    
+#ifdef ATROGUE
+    // atrogue answers no queries, list everything and read the screen
     ::pushKey('D');
-    std::this_thread::sleep_for( duration );
     ::pushKey('*');
-    std::this_thread::sleep_for( duration );
+    waitForGame();
     
-    std::string message;
     for(int i=0;i<25;i++) {
         std::string str = dungeon->getStringAtLine(i);
         if (str.length() > 2) {
@@ -769,7 +947,36 @@ void GameInterface::showDiscoveries()
     }
     
     pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-    std::this_thread::sleep_for( duration );
+#else
+    // the game is busy, the player can ask again
+    CursesTileMap::GameSnapshot snap;
+    if (!dungeon->querySnapshot(snap))
+        return;
+    
+    static const struct {
+        char type;
+        const char *heading;
+    } kinds[] = {
+        { '!', "Potions" },
+        { '?', "Scrolls" },
+        { '=', "Rings" },
+        { '/', "Wands and staffs" }
+    };
+    
+    for(int k=0;k<4;k++) {
+        std::string found;
+        for(size_t i=0;i<snap.discoveries.size();i++) {
+            const CursesTileMap::GameItem &item = snap.discoveries[i];
+            if (item.type == kinds[k].type)
+                found += "\n" + item.name;
+        }
+        if (found.length() == 0)
+            found = "\nNone";
+        if (message.length() > 0)
+            message += "\n\n";
+        message += std::string(kinds[k].heading) + ":" + found;
+    }
+#endif
     
     showMessage(message);
 }
@@ -777,7 +984,8 @@ void GameInterface::showDiscoveries()
 void GameInterface::showInventory()
 {
 
-    queryInventory(inventoryItems);
+    if (!queryInventory(inventoryItems))
+        return;
     
     for(int i=0;;i++) {
         Command *c = &inventoryItems[i];
@@ -802,8 +1010,46 @@ void GameInterface::showInventory()
     showMenu( inventoryItems );
 }
 
+char GameInterface::getIconFromItem(const CursesTileMap::GameItem &item)
+{
+    // weapons have their own tiles, mace, sword, bow, arrow, dagger,
+    // two handed sword, dart, shuriken and spear
+    static const char weaponIcons[] = { '6', ')', '4', '5', ')', ')', '5', '5', '8' };
+    
+    if (item.type == ')') {
+        if (item.which >= 0 && item.which < (int)sizeof(weaponIcons))
+            return weaponIcons[item.which];
+        return ')';
+    }
+    return item.type;
+}
+
+std::string GameInterface::getItemText(const CursesTileMap::GameItem &item)
+{
+    std::string text = std::string(1, item.letter) + ") " + item.name;
+    if (item.flags & CursesTileMap::ItemWorn)
+        text += " (being worn)";
+    if (item.flags & CursesTileMap::ItemWielded)
+        text += " (weapon in hand)";
+    if (item.flags & CursesTileMap::ItemLeftHand)
+        text += " (on left hand)";
+    else if (item.flags & CursesTileMap::ItemRightHand)
+        text += " (on right hand)";
+    return text;
+}
+
+void GameInterface::setItemCommand(Command *c, const CursesTileMap::GameItem &item, int cmd)
+{
+    c->cmd = cmd;
+    snprintf(c->text, sizeof(c->text), "%s", getItemText(item).c_str());
+    c->key = item.letter;
+    c->icon = getIconFromItem(item);
+}
+
+#ifdef ATROGUE
 char GameInterface::getIconFromString(std::string str)
 {
+    // a screen line only has the name to go by
     if (str.find("food") != std::string::npos)
         return ':';
     else if (str.find("ration") != std::string::npos)
@@ -840,67 +1086,66 @@ char GameInterface::getIconFromString(std::string str)
         return '8';
     else if (str.find("shiraken") != std::string::npos)
         return '5';
-
+    
     return 0;
 }
+#endif
 
-void GameInterface::queryInventory(Command *inv)
+bool GameInterface::queryInventory(Command *inv)
 {
     inv[0].cmd = 0;
     
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
-    
+#ifdef ATROGUE
+    // atrogue answers no queries, list the pack and read the screen
     pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-    std::this_thread::sleep_for( duration );
     pushKey((int)EventKeyboard::KeyCode::KEY_ESCAPE, false, false);
-    std::this_thread::sleep_for( duration );
     
     pushKey((int)EventKeyboard::KeyCode::KEY_I, false, false);
-    std::this_thread::sleep_for( duration );
+    waitForGame();
     
     int ii = 0;
-    for(int i=0;i<25;i++) {
+    for(int i=0;i<25 && ii<31;i++) {
         std::string str = dungeon->getStringAtLine(i);
-        if (str.length() > 2) {
-            char ch = str.c_str()[0];
-            bool hasLetter = false;
-            
-            if (str.find("--More") != std::string::npos) {
-                pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-                std::this_thread::sleep_for( duration );
-                i = 0;
-                continue;
-            }
-            
-            size_t p = str.find(")");
-            
-            if (p != std::string::npos) {
-                ch = str.c_str()[p-1];
-                if (ch >='a' && ch <= 'z') {
-                    hasLetter = true;
-                }
-            }
-            
-            if (!hasLetter)
-                continue;
-
-            Command *c = &inv[ii++];
-            strcpy(c->text, str.c_str());
-            c->cmd = ButtonCommand::InventoryItem;
-            c->key = ch;
-            c->icon = getIconFromString(str);
-            
-            // add break
-            inv[ii].cmd = 0;
-            
-            if (ii > 30)
-                break;
+        if (str.length() <= 2)
+            continue;
+        
+        if (str.find("--More") != std::string::npos) {
+            pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
+            waitForGame();
+            i = 0;
+            continue;
         }
-//        fprintf(stdout, "%s\n", dungeon->getStringAtLine(i).c_str());
+        
+        size_t p = str.find(")");
+        if (p == std::string::npos || p == 0)
+            continue;
+        char ch = str.c_str()[p-1];
+        if (ch < 'a' || ch > 'z')
+            continue;
+        
+        Command *c = &inv[ii++];
+        snprintf(c->text, sizeof(c->text), "%s", str.c_str());
+        c->cmd = ButtonCommand::InventoryItem;
+        c->key = ch;
+        c->icon = getIconFromString(str);
+        inv[ii].cmd = 0;
     }
     
     pushKey(';', false, false);
-    std::this_thread::sleep_for( duration );
+    return true;
+#else
+    // the game is busy, the player can ask again
+    CursesTileMap::GameSnapshot snap;
+    if (!dungeon->querySnapshot(snap))
+        return false;
+    
+    int ii = 0;
+    for(size_t i=0;i<snap.items.size() && ii<31;i++) {
+        setItemCommand(&inv[ii++], snap.items[i], ButtonCommand::InventoryItem);
+    }
+    inv[ii].cmd = 0;
+    return true;
+#endif
 }
 
 void GameInterface::showCommands()
@@ -932,6 +1177,7 @@ void GameInterface::showCommands()
         { Map, "Show map", 0 },
         { ToggleGraphics, "Toggle graphics", 0 },
         { Zoom, "Zoom", 0 },
+        { Explore, "Explore", 0 },
         { Help,    "Help", 0 },
         { Identify, "Identify", 0 },
         { IdentifyTrap, "Identify trap", 0 },
@@ -963,7 +1209,7 @@ void GameInterface::showMap()
     
     int th = dungeon->height();
     int tw = dungeon->width();
-    char *data = dungeon->getScreenData();
+    const char *data = dungeon->getFrameData();
     for(int r=0;r<th;r++) {
         for(int c=0;c<tw;c++) {
             char ch = data[(r*tw) + c];
@@ -1167,39 +1413,63 @@ void GameInterface::showMenu(Command *commands)
     
 }
 
+bool GameInterface::showPickableItems()
+{
+    // the game is waiting on an item prompt, offer what it would take
+    CursesTileMap::GameSnapshot snap;
+    if (!dungeon->querySnapshot(snap))
+        return false;
+    
+    // no prompt, the game has already said why
+    if (!snap.picking)
+        return true;
+    
+    Command commands[32];
+    int cc = 0;
+    for(size_t i=0;i<snap.items.size() && cc<31;i++) {
+        if (snap.items[i].flags & CursesTileMap::ItemPickable)
+            setItemCommand(&commands[cc++], snap.items[i], InventorySelect);
+    }
+    commands[cc].cmd = 0;
+    
+    // let the game tell there is nothing appropriate
+    if (cc == 0) {
+        pushKey((int)EventKeyboard::KeyCode::KEY_8, true, false);
+        return true;
+    }
+    
+    showMenu(commands);
+    return true;
+}
+
 void GameInterface::showInventorySelect(char key)
 {
     menuFrame->setVisible(false);
     messageFrame->setVisible(false);
     
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
-    
-    if (key == 0) {
-        pushKey((int)EventKeyboard::KeyCode::KEY_8, true, false);
-        std::this_thread::sleep_for( duration );
-    } else {
+    if (key != 0) {
         pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-        std::this_thread::sleep_for( duration );
         pushKey((int)EventKeyboard::KeyCode::KEY_ESCAPE, false, false);
-        std::this_thread::sleep_for( duration );
-
-        ::pushKey(key);
-        std::this_thread::sleep_for( duration );
         
+        ::pushKey(key);
+        waitForGame();
+    }
+    
 #ifdef ATROGUE
+    // atrogue answers no queries, have it list what it would take: the
+    // prompt quotes the key that does it
+    if (key == 0) {
+        pushKey((int)EventKeyboard::KeyCode::KEY_8, true, false);
+        waitForGame();
+    } else {
         std::string what = dungeon->getStringAtLine(messageLine);
         size_t whatIdx = what.find("\"");
-        if (whatIdx == std::string::npos) {
+        if (whatIdx == std::string::npos || whatIdx + 1 >= what.length()) {
             cancelPendingCommand();
             return;
         }
         ::pushKey((int) what.c_str()[whatIdx+1]);
-        std::this_thread::sleep_for( duration );
-#else
-        pushKey((int)EventKeyboard::KeyCode::KEY_8, true, false);
-        std::this_thread::sleep_for( duration );
-#endif
-        
+        waitForGame();
     }
     
     std::string str = dungeon->getStringAtLine(messageLine);
@@ -1208,49 +1478,35 @@ void GameInterface::showInventorySelect(char key)
     
     Command commands[32];
     int cc = 0;
-    for(int i=0;i<25;i++) {
+    commands[0].cmd = 0;
+    for(int i=0;i<25 && cc<31;i++) {
         std::string item = dungeon->getStringAtLine(i);
-        bool hasLetter = false;
         size_t p = item.find(")");
-        
-        if (p != std::string::npos) {
-            char ch = item.c_str()[p-1];
-            if (ch >='a' && ch <= 'z') {
-                hasLetter = true;
-            }
-        }
-        if (!hasLetter)
+        if (p == std::string::npos || p == 0)
+            continue;
+        char ch = item.c_str()[p-1];
+        if (ch < 'a' || ch > 'z' || item.length() <= 2)
             continue;
         
-        
-        if (item.length() > 2) {
-            commands[cc].cmd = InventorySelect;
-            commands[cc].icon = getIconFromString(item);
-
-            /*
-            p = item.find("[");
-            if (p != std::string::npos) {
-                item = std::string(item.c_str(), p);
-            }
-            p = item.find("(");
-            if (p != std::string::npos) {
-                item = std::string(item.c_str(), p);
-            }
-             */
-            
-            strcpy(commands[cc].text, item.c_str());
-            cc++;
-            commands[cc].cmd = 0;
-            if (item.find("--More--") != std::string::npos)
-                break;
-        }
+        commands[cc].cmd = InventorySelect;
+        commands[cc].icon = getIconFromString(item);
+        snprintf(commands[cc].text, sizeof(commands[cc].text), "%s", item.c_str());
+        cc++;
+        commands[cc].cmd = 0;
+        if (item.find("--More--") != std::string::npos)
+            break;
     }
-
+    
     if (cc != 0) {
         pushKey((int)EventKeyboard::KeyCode::KEY_SPACE, false, false);
-        std::this_thread::sleep_for( duration );
         showMenu(commands);
     }
+#else
+    // the game is busy, offer the items again over the next few frames
+    // rather than type into it
+    if (!showPickableItems())
+        pickRetry = PICK_RETRY_FRAMES;
+#endif
 }
 
 void GameInterface::deadMode()
@@ -1285,12 +1541,15 @@ void GameInterface::consumePath()
     
     if (path.size() == 0)
         return;
-
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
-    std::this_thread::sleep_for( duration);
-    
-    //sleep.sleep(0.15f);
     
+#ifndef ATROGUE
+    // rogue walks the whole way in its own thread, stopping for the same
+    // things a run does, so only the end of the path is sent
+    int ex, ey;
+    dungeon->NodeToXY(path.back(), &ex, &ey);
+    path.clear();
+    ::pushTravel(ey, ex);
+#else
     void *n = path.at(0);
     int tx, ty;
     dungeon->NodeToXY(n, &tx, &ty);
@@ -1334,7 +1593,8 @@ void GameInterface::consumePath()
         }
     }
     
-    std::this_thread::sleep_for( duration);
+    waitForGame();
+#endif
 }
 
 void GameInterface::findPath(float x, float y)
@@ -1355,8 +1615,6 @@ void GameInterface::findPath(float x, float y)
         return;
     }
     
-    Vec2 vp = Vec2(dungeon->playerLocation.x, dungeon->playerLocation.y);
-    
     CursesTileMap *map = showGraphics ? dungeon : curses;
     
     Vec2 n = map->convertToNodeSpace(Vec2(x,y));
@@ -1365,7 +1623,6 @@ void GameInterface::findPath(float x, float y)
     n.y = floor(25 - (n.y / ts.height));
     
     float totalCost = 0;
-    micropather::MicroPather pather(dungeon);
 
 //    char message[64];
 //    sprintf(message, "%f %f - %f %f\n",
@@ -1375,73 +1632,54 @@ void GameInterface::findPath(float x, float y)
 
     clearPath();
     
-    int result = pather.Solve(dungeon->XYToNode(vp.x, vp.y),
-                     dungeon->XYToNode(n.x, n.y), &path, &totalCost);
+    int result = dungeon->findPathTo(n.x, n.y, &path, &totalCost);
     
+    const GraphicsTileMap::PathStats &stats = dungeon->getPathStats();
+    CCLOG("path: %d solves, %d cached, %d resets, %.3fms last, %.3fms total",
+          stats.solves, stats.cacheHits, stats.invalidations, stats.lastSolveMs, stats.totalSolveMs);
     
-    if (result == micropather::MicroPather::SOLVED) {
-        
-        if (n.equals(lastTarget)) {
-            lastTarget = Vec2::ZERO;
-            
-            if (waitingForIdentify) {
-                char ch = dungeon->getCharAt( dungeon->getScreenData(), n.y, n.x);
-                ::pushKey(ch);
-                std::chrono::milliseconds duration(PUSH_KEY_WAIT);
-                std::this_thread::sleep_for( duration );
-                waitingForIdentify = false;
-            } else {
-                return;
-            }
-        }
-
-        lastTarget = n;
-        showPath();
+    if (result != GridPather::SOLVED) {
         path.clear();
+        return;
+    }
+    
+    // a target out of reach was swapped for the nearest reachable cell,
+    // tapping it again still walks there
+    if (n.equals(lastTarget)) {
+        lastTarget = Vec2::ZERO;
         
-    } else {
-        
-        Vec2 dd = vp - n;
-        path.push_back(dungeon->XYToNode(vp.x, vp.y));
-        
-        if ((fabs(dd.y) > 2 && fabs(dd.x) < 3) || fabs(dd.y) > 3) {
-            if (dd.y > 0) {
-                path.push_back( dungeon->XYToNode(vp.x, vp.y - 1));
-            } else {
-                path.push_back( dungeon->XYToNode(vp.x, vp.y + 1));
-            }
-        } else if (fabs(dd.x) > 3) {
-            if (dd.x > 0) {
-                path.push_back( dungeon->XYToNode(vp.x - 1, vp.y));
-            } else {
-                path.push_back( dungeon->XYToNode(vp.x + 1, vp.y));
-            }
-        }
-        
-        if (path.size() > 1) {
-            
-            int xx, yy;
-            dungeon->NodeToXY(path.at(1), &xx, &yy);
-            
-            n.x = xx;
-            n.y = yy;
-            
-            // don't bother
-            char ch = dungeon->getCharAt( dungeon->getScreenData(), n.y, n.x);
-            if (ch == '-' || ch == '|' || ch == ' ' || ch == 0 || ch == -1)
-                return;
-            
-            if (n.equals(lastTarget)) {
-                lastTarget = Vec2::ZERO;
-                return;
-            }
-            
-            lastTarget = n;
-            showPath();
+        if (waitingForIdentify) {
+            char ch = dungeon->getCharAt( dungeon->getFrameData(), n.y, n.x);
+            ::pushKey(ch);
+            waitingForIdentify = false;
+        } else {
+            return;
         }
-        
+    }
+    
+    lastTarget = n;
+    showPath();
+    path.clear();
+}
+
+void GameInterface::explore()
+{
+    clearPath();
+    
+    int x, y;
+    if (!dungeon->findExploreTarget(&x, &y)) {
+        showMessage("Nothing left to explore");
+        return;
+    }
+    
+    float totalCost = 0;
+    if (dungeon->findPathTo(x, y, &path, &totalCost) != GridPather::SOLVED) {
         path.clear();
+        return;
     }
+    
+    lastTarget = Vec2::ZERO;
+    showPath();
 }
 
 void GameInterface::showPath()
@@ -1582,16 +1820,13 @@ void GameInterface::hideKeyboard()
 
 void GameInterface::consumeStringInput(std::string sz)
 {
-    std::chrono::milliseconds duration(PUSH_KEY_WAIT);
     sz += "  ";
     
     if (sz.find("esc") != std::string::npos) {
         pushKey((int)EventKeyboard::KeyCode::KEY_ESCAPE, false, false);
-        std::this_thread::sleep_for( duration );
         hideKeyboard();
     } else if (sz.find("delete") != std::string::npos) {
         ::pushKey('\b');
-        std::this_thread::sleep_for( duration );
         return;
     } else if (sz.find("shift") != std::string::npos) {
         keyboardShift = !keyboardShift;
@@ -1600,10 +1835,8 @@ void GameInterface::consumeStringInput(std::string sz)
         return;
     } else  if (sz.find("enter") != std::string::npos) {
         pushKey((int)EventKeyboard::KeyCode::KEY_ENTER, false, false);
-        std::this_thread::sleep_for( duration );
         hideKeyboard();
     } else {
         ::pushKey(sz.c_str()[1]);
-        std::this_thread::sleep_for( duration );
     }
 }
@@ -63,6 +63,7 @@ class GameInterface : public cocos2d::Node
         Help,
         Cancel,
         Zoom,
+        Explore,
         Exit
     };
     
@@ -116,9 +117,20 @@ public:
 protected:
     
     bool isDungeon();
-    
-    char getIconFromString(std::string text);
-    void queryInventory(Command *cmd);
+    void consumeEvents();
+    void showHudMessage(const std::string &message);
+#ifdef ATROGUE
+    void scrapeHud();
+#endif
+    void showStats(const CursesTileMap::GameStats &stats);
+    
+    char getIconFromItem(const CursesTileMap::GameItem &item);
+    std::string getItemText(const CursesTileMap::GameItem &item);
+    void setItemCommand(Command *c, const CursesTileMap::GameItem &item, int cmd);
+#ifdef ATROGUE
+    char getIconFromString(std::string str);
+#endif
+    bool queryInventory(Command *cmd);
     void showPlayerInfo();
     void showInventory();
     void showCommands();
@@ -127,6 +139,7 @@ protected:
     void showMessage(std::string message);
     void showMenu(Command *commands);
     void showInventorySelect(char key);
+    bool showPickableItems();
     void showDiscoveries();
     void showKeyboard();
     void hideKeyboard();
@@ -143,7 +156,11 @@ private:
     cocos2d::Node *keyboard;
     cocos2d::Node *toolbar;
     cocos2d::ui::Button *go;
-    cocos2d::Label *statsLabel;
+    // the status line, one label per field: level, gold, hp, str, arm,
+    // exp and hunger
+    enum { StatsFieldCount = 7 };
+    cocos2d::Label *statsFields[StatsFieldCount];
+    float statsGap;
     cocos2d::Label *messageLabel;
     cocos2d::ui::Scale9Sprite *messageFrame;
     cocos2d::ui::Scale9Sprite *menuFrame;
@@ -151,6 +168,7 @@ private:
     cocos2d::ui::Scale9Sprite *messageLabelFrame;
     
     void findPath(float x, float y);
+    void explore();
     
     float pressX;
     float pressY;
@@ -165,6 +183,11 @@ private:
     
     int messageLine;
     int statsLine;
+    int currentLevel;
+    int pendingPrompt;
+    int pickRetry;
+    bool statsShown;
+    CursesTileMap::GameStats shownStats;
     
     cocos2d::Vec2 lastTarget;
     
@@ -7,55 +7,91 @@
 //
 
 #include "GraphicsTileMap.hpp"
+#include <chrono>
 
 USING_NS_CC;
 
-extern "C" {
-    int what_thing(int y, int x);
-}
+// how fast the camera closes in on the hero, per second
+#define CAMERA_EASE 10.0f
+// hero moves longer than this many cells are not scrolled
+#define CAMERA_JUMP 8.0f
+// solved paths kept for the current map
+#define PATH_CACHE_SIZE 64
+
+// longest path a solve can return
+#define PATH_MAX_LENGTH GridPather::Cells
 
 GraphicsTileMap::GraphicsTileMap() : CursesTileMap()
-{}
+{
+    memset(wallKinds, 0, sizeof(wallKinds));
+    cameraValid = false;
+    
+    memset(&pathStats, 0, sizeof(pathStats));
+    memset(walkMap, GridPather::WalkBlocked, sizeof(walkMap));
+    walkGeneration = 0;
+    pathGeneration = -1;
+    
+    memset(visited, 0, sizeof(visited));
+    memset(shaded, 0, sizeof(shaded));
+    shadeChanged = false;
+}
 
-void GraphicsTileMap::centerAt()
+void GraphicsTileMap::centerAt(bool snap)
 {
-    char *data = getScreenData(false);
+    // the game publishes where the hero is, no need to look for him
+    const FrameInfo &info = getFrameInfo();
+    if (info.heroY < 0)
+        return;
     
-    int tw = _terminalSize.width;
+    Vec2 lastLocation = playerLocation;
+    playerLocation = Vec2(info.heroX, info.heroY);
     
     int cw = getTileSize().width;
     int ch = getTileSize().height;
     float scale = getScale();
     
-    auto visibleSize = Director::getInstance()->getVisibleSize();
     auto winSize = Director::getInstance()->getWinSize();
-    Vec2 origin = Director::getInstance()->getVisibleOrigin();
-    
-    float cX = 0;
-    float cY = 0;
     
-    for(int r=0;r<_terminalSize.height;r++) {
-        for(int c=0;c<_terminalSize.width;c++) {
-            char cc = data[(r*tw) + c];
-            if (cc == '@') {
-                cX = (c * cw * scale);
-                cY = ((r + 1) * ch * scale);
-                playerLocation = Vec2(c, r);
-                break;
-            }
+    // hold still on a room that fits on screen, follow the hero otherwise
+    float fx = info.heroX;
+    float fy = info.heroY;
+    if (info.roomTop >= 0) {
+        float rw = (info.roomRight - info.roomLeft + 1) * cw * scale;
+        float rh = (info.roomBottom - info.roomTop + 1) * ch * scale;
+        if (rw < winSize.width && rh < winSize.height) {
+            fx = (info.roomLeft + info.roomRight) * 0.5f;
+            fy = (info.roomTop + info.roomBottom) * 0.5f;
         }
     }
-
+    
+    float cX = (fx * cw * scale);
+    float cY = ((fy + 1) * ch * scale);
     float tmxH = (_terminalSize.height * ch * scale);
     
     setAnchorPoint(Vec2(0,0));
-    Vec2 pos = Vec2(-cX + (winSize.width/2), -(tmxH-cY) + (winSize.height/2));
-    setPosition(pos);
+    cameraTarget = Vec2(-cX + (winSize.width/2), -(tmxH-cY) + (winSize.height/2));
     
-    /*
-    this->stopAllActions();
-    this->runAction(MoveTo::create(0.2, pos));
-     */
+    // new levels and teleports jump, walking scrolls
+    if (snap || !cameraValid || lastLocation.distance(playerLocation) > CAMERA_JUMP) {
+        cameraPosition = cameraTarget;
+        cameraValid = true;
+        setPosition(cameraTarget);
+    }
+}
+
+void GraphicsTileMap::updateCamera(float delta)
+{
+    if (!cameraValid || cameraPosition == cameraTarget)
+        return;
+    
+    // ease towards the target, drawn on whole pixels so tiles stay crisp
+    Vec2 d = cameraTarget - cameraPosition;
+    if (d.length() < 0.5f)
+        cameraPosition = cameraTarget;
+    else
+        cameraPosition += d * std::min(1.0f, delta * CAMERA_EASE);
+    
+    setPosition(Vec2(roundf(cameraPosition.x), roundf(cameraPosition.y)));
 }
 
 void GraphicsTileMap::loadTileset()
@@ -178,7 +214,7 @@ void GraphicsTileMap::loadTileset()
 #endif
 }
 
-char GraphicsTileMap::getCharAt(char *data, int r, int c) {
+char GraphicsTileMap::getCharAt(const char *data, int r, int c) {
     int tw = _terminalSize.width;
     if (r < 0 || r >= _terminalSize.height)
         return '?';
@@ -187,8 +223,83 @@ char GraphicsTileMap::getCharAt(char *data, int r, int c) {
     return data[(r*tw) + c];
 }
 
-bool isWall(char c, char c2) {
-    return c == '-' || c == '|' || c == '+' || (c == '@' && c2 == '|');
+// autotiler: what each glyph is as far as walls go, and the corner tile
+// for every combination of wall neighbours
+enum WallKind {
+    NotWall = 0,
+    HorizontalWall,
+    VerticalWall,
+    Door,
+    Hero
+};
+
+#define WALL_N  0x01
+#define WALL_S  0x02
+#define WALL_W  0x04
+#define WALL_E  0x08
+#define WALL_NW 0x10
+#define WALL_NE 0x20
+#define WALL_SW 0x40
+#define WALL_SE 0x80
+
+// how far out a corner's mask looks: joinsWall() reads past a hero
+// standing in a doorway to the cell beyond him
+#define WALL_REACH 2
+
+// cells of padding around the wall kind grid, so neighbours that far
+// out need no bounds checks
+#define WALL_PAD WALL_REACH
+#define WALL_STRIDE (80 + WALL_PAD * 2)
+
+static unsigned char wallKindMap[256];
+static char cornerTileMap[256];
+
+static void buildAutotileTables()
+{
+    static bool built = false;
+    if (built)
+        return;
+    built = true;
+    
+    memset(wallKindMap, NotWall, sizeof(wallKindMap));
+    wallKindMap['-'] = HorizontalWall;
+    wallKindMap['|'] = VerticalWall;
+    wallKindMap['+'] = Door;
+    wallKindMap['@'] = Hero;
+    
+    for(int mask=0;mask<256;mask++) {
+        bool n = mask & WALL_N;
+        bool s = mask & WALL_S;
+        bool w = mask & WALL_W;
+        bool e = mask & WALL_E;
+        
+        // the room side diagonal of a corner is never a wall
+        char cc = 0;
+        if (!w && e && s && !(mask & WALL_SE)) {
+            cc = '0';
+        } else if (w && !e && s && !(mask & WALL_SW)) {
+            cc = '1';
+        } else if (!w && e && n && !(mask & WALL_NE)) {
+            cc = '2';
+        } else if (w && !e && n && !(mask & WALL_NW)) {
+            cc = '3';
+        }
+        cornerTileMap[mask] = cc;
+    }
+}
+
+static inline bool isWallKind(unsigned char k)
+{
+    return k == HorizontalWall || k == VerticalWall || k == Door;
+}
+
+// a neighbour joins the wall if it is one, or if the hero stands in a
+// doorway and the wall carries on past him
+static inline bool joinsWall(const unsigned char *kind, int step, unsigned char along)
+{
+    if (isWallKind(kind[step]))
+        return true;
+    return kind[step] == Hero && (kind[step*2] == along || kind[step*2] == Door);
 }
 
  #define MACE		0
@@ -204,6 +315,9 @@ bool isWall(char c, char c2) {
 
 void GraphicsTileMap::modifyWeaponTiles(char *data)
 {
+    // weapon kinds come from the overlay published with the frame
+    const unsigned char *things = frameThings;
+    
     int tw = _terminalSize.width;
     for(int r=0;r<_terminalSize.height;r++) {
         for(int c=0;c<_terminalSize.width;c++) {
@@ -213,7 +327,7 @@ void GraphicsTileMap::modifyWeaponTiles(char *data)
             if (cc != ')')
                 continue;
             
-            int wt = what_thing(r, c);
+            int wt = things[(r*tw) + c];
             switch (wt) {
                 case MACE:
                     cc = '6';
@@ -239,119 +353,314 @@ void GraphicsTileMap::modifyWeaponTiles(char *data)
 
 void GraphicsTileMap::modifyCornerTiles(char *data)
 {
+    // a corner only depends on the cells within WALL_REACH of it, so
+    // redo the damaged cells and the ones that close to them
+    growDamage(WALL_REACH, WALL_REACH);
+    buildAutotileTables();
+    
     int tw = _terminalSize.width;
-    for(int r=0;r<_terminalSize.height;r++) {
-        for(int c=0;c<_terminalSize.width;c++) {
-            
-            char cc = data[(r*tw) + c];
+    int th = std::min((int)_terminalSize.height, 25);
+    
+    // classify the rows the masks will look at
+    for(int r=0;r<th;r++) {
+        bool needed = false;
+        for(int rr=std::max(0,r-WALL_PAD);rr<=std::min(th-1,r+WALL_PAD);rr++) {
+            if (damageFirst[rr] != -1) {
+                needed = true;
+                break;
+            }
+        }
+        if (!needed)
+            continue;
+        
+        unsigned char *kind = &wallKinds[((r + WALL_PAD) * WALL_STRIDE) + WALL_PAD];
+        const unsigned char *row = (const unsigned char*)&data[r*tw];
+        for(int c=0;c<tw;c++) {
+            kind[c] = wallKindMap[row[c]];
+        }
+    }
+    
+    for(int r=0;r<th;r++) {
+        
+        if (damageFirst[r] == -1)
+            continue;
+        
+        int last = std::min((int)damageLast[r], tw - 1);
+        
+        for(int c=damageFirst[r];c<=last;c++) {
             
-            if (cc != '-')
+            const unsigned char *kind = &wallKinds[((r + WALL_PAD) * WALL_STRIDE) + c + WALL_PAD];
+            if (*kind != HorizontalWall && *kind != VerticalWall)
                 continue;
             
-            char left = getCharAt(data, r, c-1);
-            char right = getCharAt(data, r, c+1);
-            char up = getCharAt(data, r-1, c);
-            char down = getCharAt(data, r+1, c);
-            
-//            char left2 = getCharAt(data, r, c-2);
-//            char right2 = getCharAt(data, r, c+2);
-            char up2 = getCharAt(data, r-2, c);
-            char down2 = getCharAt(data, r+2, c);
-            
-            if (!isWall(left,'|') && isWall(right,'|') && isWall(down,down2)) {
-                cc = '0';
-            } else if (isWall(left,'|') && !isWall(right,'|') && isWall(down,down2)) {
-                cc = '1';
-            } else if (!isWall(left,'|') && isWall(right,'|') && isWall(up,up2)) {
-                cc = '2';
-            } else if (isWall(left,'|') && !isWall(right,'|') && isWall(up,up2)) {
-                cc = '3';
-            }
+            int mask = 0;
+            if (joinsWall(kind, -WALL_STRIDE, VerticalWall))
+                mask |= WALL_N;
+            if (joinsWall(kind, WALL_STRIDE, VerticalWall))
+                mask |= WALL_S;
+            if (joinsWall(kind, -1, HorizontalWall))
+                mask |= WALL_W;
+            if (joinsWall(kind, 1, HorizontalWall))
+                mask |= WALL_E;
+            if (isWallKind(kind[-WALL_STRIDE - 1]))
+                mask |= WALL_NW;
+            if (isWallKind(kind[-WALL_STRIDE + 1]))
+                mask |= WALL_NE;
+            if (isWallKind(kind[WALL_STRIDE - 1]))
+                mask |= WALL_SW;
+            if (isWallKind(kind[WALL_STRIDE + 1]))
+                mask |= WALL_SE;
             
-            data[(r*tw) + c] = cc;
+            char cc = cornerTileMap[mask];
+            if (cc != 0)
+                data[(r*tw) + c] = cc;
         }
     }
 }
 
 
-float GraphicsTileMap::LeastCostEstimate( void* nodeStart, void* nodeEnd )
+void GraphicsTileMap::updateWalkMap(const char *data)
 {
-    int xStart, yStart, xEnd, yEnd;
-    NodeToXY( nodeStart, &xStart, &yStart );
-    NodeToXY( nodeEnd, &xEnd, &yEnd );
-    return Vec2(xStart, yStart).distance(Vec2(xEnd,yEnd));
+    // only damaged cells can have changed since the last frame
+    bool changed = false;
+    
+    for(int r=0;r<25;r++) {
+        if (damageFirst[r] == -1)
+            continue;
+        
+        for(int c=damageFirst[r];c<=damageLast[r];c++) {
+            char ch = data[(r*80) + c];
+            unsigned char walk = GridPather::WalkPassable;
+            if (ch == '-' || ch == '|' || ch == '@' || ch == ' ' || ch == 0  || ch == -1)
+                walk = GridPather::WalkBlocked;
+            else if (ch == '.' || ch == '#')
+                walk = GridPather::WalkOpen;
+            
+            if (walkMap[(r*80) + c] != walk) {
+                walkMap[(r*80) + c] = walk;
+                changed = true;
+            }
+        }
+    }
+    
+    if (changed)
+        walkGeneration++;
 }
 
-void GraphicsTileMap::AdjacentCost( void* state, std::vector< micropather::StateCost > *adjacent )
+int GraphicsTileMap::solvePath(void *start, void *end, std::vector<void*> *path, float *totalCost)
 {
-    char *data = getScreenData(false);
-    int tw = _terminalSize.width;
+    // the legal moves of every cell are worked out once for each change
+    // of the walkable cells, along with dropping the paths solved before
+    if (pathGeneration != walkGeneration) {
+        pathGeneration = walkGeneration;
+        pather.setWalkMap(walkMap);
+        pathCache.clear();
+        pathStats.invalidations++;
+    }
+    
+    std::pair<void*, void*> key(start, end);
+    auto it = pathCache.find(key);
+    if (it != pathCache.end()) {
+        pathStats.cacheHits++;
+        *path = it->second.path;
+        *totalCost = it->second.cost;
+        return it->second.result;
+    }
+    
+    int sx, sy, ex, ey;
+    NodeToXY(start, &sx, &sy);
+    NodeToXY(end, &ex, &ey);
+    
+    short cells[PATH_MAX_LENGTH];
+    int length = 0;
     
-    int x, y;
-    NodeToXY( state, &x, &y );
+    auto t0 = std::chrono::steady_clock::now();
+    int result = pather.solve((sy*GridPather::Cols) + sx, (ey*GridPather::Cols) + ex,
+                              cells, PATH_MAX_LENGTH, &length, totalCost);
+    auto t1 = std::chrono::steady_clock::now();
     
-    char left = getCharAt(data, y, x-1);
-    char right = getCharAt(data, y, x+1);
-    char up = getCharAt(data, y-1, x);
-    char down = getCharAt(data, y+1, x);
+    copyPath(cells, length, path);
     
-    bool allowDiagonal = true;
+    pathStats.solves++;
+    pathStats.lastSolveMs = std::chrono::duration<float, std::milli>(t1 - t0).count();
+    pathStats.totalSolveMs += pathStats.lastSolveMs;
     
-    if (left != '.' && left != '#' && right != '.' && right != '#') {
-        allowDiagonal = false;
+    if (pathCache.size() >= PATH_CACHE_SIZE)
+        pathCache.clear();
+    CachedPath &cached = pathCache[key];
+    cached.result = result;
+    cached.cost = *totalCost;
+    cached.path = *path;
+    
+    return result;
+}
+
+void GraphicsTileMap::copyPath(const short *cells, int length, std::vector<void*> *path)
+{
+    path->clear();
+    for(int i=0;i<length;i++) {
+        path->push_back(XYToNode(cells[i] % GridPather::Cols, cells[i] / GridPather::Cols));
     }
-    if (up != '.' && up != '#' && down != '.' && down != '#') {
-        allowDiagonal = false;
+}
+
+int GraphicsTileMap::getHeroCell()
+{
+    const FrameInfo &info = getFrameInfo();
+    if (info.heroY < 0 || info.heroX < 0)
+        return -1;
+    return (info.heroY * GridPather::Cols) + info.heroX;
+}
+
+void GraphicsTileMap::requestDistanceField()
+{
+    int hero = getHeroCell();
+    if (hero < 0)
+        return;
+    
+    visited[hero] = 1;
+    if (!field.isCurrent(hero, walkGeneration))
+        field.request(walkMap, hero, walkGeneration);
+}
+
+bool GraphicsTileMap::pollDistanceField()
+{
+    // cells that flip between reachable and not are redrawn
+    if (field.poll()) {
+        for(int r=0;r<25;r++) {
+            for(int c=0;c<80;c++) {
+                int cell = (r*80) + c;
+                unsigned char s = walkMap[cell] != GridPather::WalkBlocked && !field.isReachable(cell);
+                if (shaded[cell] != s) {
+                    shaded[cell] = s;
+                    addDamage(r, c, c);
+                    shadeChanged = true;
+                }
+            }
+        }
     }
     
-    for(int r=0;r<3;r++) {
-        for(int c=0;c<3;c++) {
-            
-            bool isDiagonal = ((c == 0 || c == 2) && (r == 0 || r == 2));
-            
-            if (!allowDiagonal && isDiagonal) {
+    bool changed = shadeChanged;
+    shadeChanged = false;
+    return changed;
+}
+
+Color3B GraphicsTileMap::shadeTile(int r, int c, const Color3B &color)
+{
+    if (r < 25 && c < 80 && shaded[(r*80) + c])
+        return Color3B(color.r / 2, color.g / 2, color.b / 2);
+    return color;
+}
+
+int GraphicsTileMap::findPathTo(int x, int y, std::vector<void*> *path, float *totalCost)
+{
+    int hero = getHeroCell();
+    if (hero < 0 || x < 0 || y < 0 || x >= 80 || y >= 25)
+        return GridPather::NO_SOLUTION;
+    
+    // keep any damage from a late flood for the next draw
+    if (field.poll())
+        shadeChanged = true;
+    
+    // not flooded for this frame yet, solve just this one
+    if (!field.isCurrent(hero, walkGeneration))
+        return solvePath(XYToNode(hero % 80, hero / 80), XYToNode(x, y), path, totalCost);
+    
+    // out of reach, head for the reachable cell closest to it
+    int target = (y*80) + x;
+    if (!field.isReachable(target)) {
+        int best = -1;
+        int bestDistance = 0;
+        for(int cell=0;cell<GridPather::Cells;cell++) {
+            if (!field.isReachable(cell))
                 continue;
+            int dx = abs((cell % 80) - x);
+            int dy = abs((cell / 80) - y);
+            int d = (std::max(dx, dy) * 2) + std::min(dx, dy);
+            if (best == -1 || d < bestDistance ||
+                (d == bestDistance && field.getDistance(cell) < field.getDistance(best))) {
+                best = cell;
+                bestDistance = d;
             }
+        }
+        if (best == -1)
+            return GridPather::NO_SOLUTION;
+        target = best;
+    }
+    
+    short cells[PATH_MAX_LENGTH];
+    int length = 0;
+    int result = field.pathTo(target, cells, PATH_MAX_LENGTH, &length, totalCost);
+    copyPath(cells, length, path);
+    return result;
+}
 
-            int xx = x-1+c;
-            int yy = y-1+r;
-            
-            if (xx < 0 || xx >= _terminalSize.width)
-                continue;
-            if (yy < 0 || yy >= _terminalSize.height)
-                continue;
-            
-            char ch = data[(yy*tw) + xx];
-            if (ch == '-' || ch == '|' || ch == '@' || ch == ' ' || ch == 0  || ch == -1)
-                continue;
-            
-            char left = getCharAt(data, yy, xx-1);
-            char right = getCharAt(data, yy, xx+1);
-            char up = getCharAt(data, yy-1, xx);
-            char down = getCharAt(data, yy+1, xx);
-            
-            if ((c == 0 && r == 0) || (c == 2 && r == 0) ||
-                (c == 0 && r == 2) || (c == 2 && r == 2)) {
-                if (left != '.' && left != '#' && right != '.' && right != '#') {
-                    continue;
-                }
-                if (up != '.' && up != '#' && down != '.' && down != '#') {
-                    continue;
+bool GraphicsTileMap::findExploreTarget(int *x, int *y)
+{
+    int hero = getHeroCell();
+    if (hero < 0)
+        return false;
+    if (field.poll())
+        shadeChanged = true;
+    if (!field.isCurrent(hero, walkGeneration))
+        return false;
+    
+    // the nearest door not yet gone through or passage not yet followed
+    // to its end, else the stairs
+    const char *data = getFrameData();
+    int best = -1;
+    int stairs = -1;
+    for(int cell=0;cell<GridPather::Cells;cell++) {
+        if (cell == hero || !field.isReachable(cell))
+            continue;
+        
+        char ch = data[cell];
+        if (ch == '%') {
+            if (stairs == -1 || field.getDistance(cell) < field.getDistance(stairs))
+                stairs = cell;
+            continue;
+        }
+        if (visited[cell])
+            continue;
+        
+        bool frontier = (ch == '+');
+        if (ch == '#') {
+            // a passage cell with one way on is where it stops being known;
+            // the hero's own cell counts as a way on
+            int ways = 0;
+            int r = cell / 80;
+            int c = cell % 80;
+            for(int dr=-1;dr<=1;dr++) {
+                for(int dc=-1;dc<=1;dc++) {
+                    int rr = r + dr;
+                    int cc = c + dc;
+                    if ((dr == 0 && dc == 0) || rr < 0 || cc < 0 || rr >= 25 || cc >= 80)
+                        continue;
+                    int n = (rr*80) + cc;
+                    if (n == hero || walkMap[n] != GridPather::WalkBlocked)
+                        ways++;
                 }
             }
-            
-            
-            micropather::StateCost nodeCost = { XYToNode( xx, yy ), 1 };
-            if (isDiagonal)
-                nodeCost.cost = 1.5;
-            adjacent->push_back( nodeCost );
-            
+            frontier = ways <= 1;
         }
+        
+        if (frontier && (best == -1 || field.getDistance(cell) < field.getDistance(best)))
+            best = cell;
     }
+    
+    if (best == -1)
+        best = stairs;
+    if (best == -1)
+        return false;
+    
+    *x = best % 80;
+    *y = best / 80;
+    return true;
 }
 
-void GraphicsTileMap::PrintStateInfo( void* state )
-{}
+void GraphicsTileMap::clearVisited()
+{
+    memset(visited, 0, sizeof(visited));
+}
 
 void GraphicsTileMap::NodeToXY( void* node, int* x, int* y )
 {
@@ -10,30 +10,84 @@
 #define GraphicsTileMap_hpp
 
 #include "CursesTileMap.hpp"
-#include "micropather.h"
+#include "GridPather.hpp"
+#include "DistanceField.hpp"
+#include <map>
 
-class GraphicsTileMap : public CursesTileMap, public micropather::Graph
+class GraphicsTileMap : public CursesTileMap
 {
 public:
     
     GraphicsTileMap();
     void loadTileset();
     
-    void centerAt();
+    void centerAt(bool snap = false);
+    void updateCamera(float delta);
     
-    char getCharAt(char *data, int r, int c);
+    char getCharAt(const char *data, int r, int c);
     void modifyCornerTiles(char *data);
     void modifyWeaponTiles(char *data);
     
-    // graph
-    float LeastCostEstimate( void* stateStart, void* stateEnd );
-    void AdjacentCost( void* state, std::vector< micropather::StateCost > *adjacent );
-    void PrintStateInfo( void* state );
-    
     void NodeToXY( void* node, int* x, int* y );
     void* XYToNode( int x, int y );
     
+    // path finding, the pather and its cache live as long as the map and
+    // are rebuilt only when a damaged cell changes how it can be walked
+    struct PathStats {
+        unsigned int solves;
+        unsigned int cacheHits;
+        unsigned int invalidations;
+        float lastSolveMs;
+        float totalSolveMs;
+    };
+    
+    void updateWalkMap(const char *data);
+    int solvePath(void *start, void *end, std::vector<void*> *path, float *totalCost);
+    const PathStats &getPathStats() { return pathStats; }
+    
+    // distance field from the hero, asked for with every new frame and
+    // picked up once the worker is done
+    void requestDistanceField();
+    bool pollDistanceField();
+    int findPathTo(int x, int y, std::vector<void*> *path, float *totalCost);
+    bool findExploreTarget(int *x, int *y);
+    void clearVisited();
+    
+    virtual cocos2d::Color3B shadeTile(int r, int c, const cocos2d::Color3B &color);
+    
     cocos2d::Vec2 playerLocation;
+    
+protected:
+    
+    struct CachedPath {
+        int result;
+        float cost;
+        std::vector<void*> path;
+    };
+    
+    GridPather pather;
+    std::map<std::pair<void*, void*>, CachedPath> pathCache;
+    PathStats pathStats;
+    
+    // walk class of every cell and a generation bumped when any changes
+    unsigned char walkMap[25 * 80];
+    unsigned long walkGeneration;
+    unsigned long pathGeneration;
+    
+    DistanceField field;
+    unsigned char visited[25 * 80];
+    unsigned char shaded[25 * 80];   // walkable but out of reach
+    bool shadeChanged;
+    
+    int getHeroCell();
+    void copyPath(const short *cells, int length, std::vector<void*> *path);
+    
+    cocos2d::Vec2 cameraTarget;
+    cocos2d::Vec2 cameraPosition;
+    bool cameraValid;
+    
+    // wall kind of every cell with a two cell border, see modifyCornerTiles
+    unsigned char wallKinds[(25 + 4) * (80 + 4)];
 };
 
 #endif /* GraphicsTileMap_hpp */
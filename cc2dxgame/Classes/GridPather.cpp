@@ -0,0 +1,219 @@
+//
+//  GridPather.cpp
+//  cc2dxgame
+//
+//
+
+#include "GridPather.hpp"
+#include <string.h>
+#include <stdlib.h>
+
+// costs are kept in half steps so diagonals (1.5) stay integers
+#define STRAIGHT_COST 2
+#define DIAGONAL_COST 3
+
+// directions as bits of moves[], straight ones first
+static const int dirX[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+static const int dirY[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+static int walkAt(const unsigned char *walk, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= GridPather::Cols || y >= GridPather::Rows)
+        return GridPather::WalkBlocked;
+    return walk[(y * GridPather::Cols) + x];
+}
+
+// a diagonal step needs open ground beside both ends, horizontally and
+// vertically, which keeps the hero from cutting round doors and corners
+static bool allowsDiagonal(const unsigned char *walk, int x, int y)
+{
+    if (walkAt(walk, x-1, y) != GridPather::WalkOpen && walkAt(walk, x+1, y) != GridPather::WalkOpen)
+        return false;
+    if (walkAt(walk, x, y-1) != GridPather::WalkOpen && walkAt(walk, x, y+1) != GridPather::WalkOpen)
+        return false;
+    return true;
+}
+
+// octile distance, never more than the real cost
+static int estimate(int from, int to)
+{
+    int dx = abs((from % GridPather::Cols) - (to % GridPather::Cols));
+    int dy = abs((from / GridPather::Cols) - (to / GridPather::Cols));
+    if (dx < dy)
+        return (STRAIGHT_COST * dy) + ((DIAGONAL_COST - STRAIGHT_COST) * dx);
+    return (STRAIGHT_COST * dx) + ((DIAGONAL_COST - STRAIGHT_COST) * dy);
+}
+
+GridPather::GridPather()
+{
+    memset(moves, 0, sizeof(moves));
+    memset(enterable, 0, sizeof(enterable));
+    heapSize = 0;
+}
+
+void GridPather::setWalkMap(const unsigned char *walk)
+{
+    bool diagonal[Cells];
+    for(int y=0;y<Rows;y++) {
+        for(int x=0;x<Cols;x++) {
+            diagonal[(y*Cols) + x] = allowsDiagonal(walk, x, y);
+        }
+    }
+    
+    for(int y=0;y<Rows;y++) {
+        for(int x=0;x<Cols;x++) {
+            int cell = (y*Cols) + x;
+            enterable[cell] = walk[cell] != WalkBlocked;
+            unsigned char m = 0;
+            for(int d=0;d<8;d++) {
+                int xx = x + dirX[d];
+                int yy = y + dirY[d];
+                if (walkAt(walk, xx, yy) == WalkBlocked)
+                    continue;
+                if (d >= 4 && !(diagonal[cell] && diagonal[(yy*Cols) + xx]))
+                    continue;
+                m |= 1 << d;
+            }
+            moves[cell] = m;
+        }
+    }
+}
+
+void GridPather::push(int f, int cell)
+{
+    // f stays well under 2^13 on this map, cell under 2^11
+    unsigned int key = ((unsigned int)f << 11) | (unsigned int)cell;
+    int i = heapSize++;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (heap[p] <= key)
+            break;
+        heap[i] = heap[p];
+        i = p;
+    }
+    heap[i] = key;
+}
+
+int GridPather::pop()
+{
+    unsigned int top = heap[0];
+    unsigned int last = heap[--heapSize];
+    int i = 0;
+    for(;;) {
+        int c = (i * 2) + 1;
+        if (c >= heapSize)
+            break;
+        if (c + 1 < heapSize && heap[c + 1] < heap[c])
+            c++;
+        if (last <= heap[c])
+            break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = last;
+    return top & 0x7ff;
+}
+
+int GridPather::solve(int start, int end, short *path, int maxPath, int *length, float *cost)
+{
+    *length = 0;
+    *cost = 0;
+    
+    if (start < 0 || end < 0 || start >= Cells || end >= Cells)
+        return NO_SOLUTION;
+    if (start == end)
+        return START_END_SAME;
+    if (!enterable[end])
+        return NO_SOLUTION;
+    
+    memset(g, 0xff, sizeof(g));
+    memset(closed, 0, sizeof(closed));
+    heapSize = 0;
+    
+    g[start] = 0;
+    parent[start] = -1;
+    push(estimate(start, end), start);
+    
+    while (heapSize > 0) {
+        int cell = pop();
+        if (closed[cell >> 5] & (1u << (cell & 31)))
+            continue;
+        closed[cell >> 5] |= 1u << (cell & 31);
+        
+        if (cell == end)
+            break;
+        
+        int x = cell % Cols;
+        int y = cell / Cols;
+        unsigned char m = moves[cell];
+        for(int d=0;d<8;d++) {
+            if (!(m & (1 << d)))
+                continue;
+            
+            int next = ((y + dirY[d]) * Cols) + x + dirX[d];
+            int cg = g[cell] + (d < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            if (cg >= g[next])
+                continue;
+            
+            g[next] = cg;
+            parent[next] = cell;
+            push(cg + estimate(next, end), next);
+        }
+    }
+    
+    if (!(closed[end >> 5] & (1u << (end & 31))))
+        return NO_SOLUTION;
+    
+    int count = 0;
+    for(int c=end;c!=-1;c=parent[c])
+        count++;
+    if (count > maxPath)
+        return NO_SOLUTION;
+    
+    int i = count;
+    for(int c=end;c!=-1;c=parent[c])
+        path[--i] = c;
+    
+    *length = count;
+    *cost = g[end] / (float)STRAIGHT_COST;
+    return SOLVED;
+}
+
+void GridPather::flood(int origin, unsigned short *dist, short *parent)
+{
+    // dijkstra without a goal, the same expansion as solve()
+    memset(dist, 0xff, sizeof(unsigned short) * Cells);
+    memset(closed, 0, sizeof(closed));
+    heapSize = 0;
+    
+    if (origin < 0 || origin >= Cells)
+        return;
+    
+    dist[origin] = 0;
+    parent[origin] = -1;
+    push(0, origin);
+    
+    while (heapSize > 0) {
+        int cell = pop();
+        if (closed[cell >> 5] & (1u << (cell & 31)))
+            continue;
+        closed[cell >> 5] |= 1u << (cell & 31);
+        
+        int x = cell % Cols;
+        int y = cell / Cols;
+        unsigned char m = moves[cell];
+        for(int d=0;d<8;d++) {
+            if (!(m & (1 << d)))
+                continue;
+            
+            int next = ((y + dirY[d]) * Cols) + x + dirX[d];
+            int cg = dist[cell] + (d < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            if (cg >= dist[next])
+                continue;
+            
+            dist[next] = cg;
+            parent[next] = cell;
+            push(cg, next);
+        }
+    }
+}
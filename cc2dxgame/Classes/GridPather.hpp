@@ -0,0 +1,69 @@
+//
+//  GridPather.hpp
+//  cc2dxgame
+//
+//
+
+#ifndef GridPather_hpp
+#define GridPather_hpp
+
+// A* over the fixed 80x25 terminal, with rogue's movement rules turned
+// into a mask of legal moves per cell whenever the map changes. every
+// buffer is a member, solving never touches the heap
+class GridPather
+{
+public:
+    
+    enum {
+        Cols = 80,
+        Rows = 25,
+        Cells = Cols * Rows
+    };
+    
+    // same results as micropather
+    enum {
+        SOLVED,
+        NO_SOLUTION,
+        START_END_SAME
+    };
+    
+    // how a cell can be walked
+    enum WalkClass {
+        WalkBlocked = 0,
+        WalkOpen,       // floor and passages, diagonal moves need one beside
+        WalkPassable    // doors, stairs, things and monsters
+    };
+    
+    GridPather();
+    
+    void setWalkMap(const unsigned char *walk);
+    
+    // fills 'path' with the cells from start to end inclusive and returns
+    // SOLVED, 'length' and 'cost' are left at 0 otherwise
+    int solve(int start, int end, short *path, int maxPath, int *length, float *cost);
+    
+    // cost in half steps from 'origin' to every cell, Unreachable where
+    // there is no way, and the cell each one is reached from
+    enum {
+        Unreachable = 0xffff
+    };
+    void flood(int origin, unsigned short *dist, short *parent);
+    
+private:
+    
+    void push(int f, int cell);
+    int pop();
+    
+    unsigned char moves[Cells];         // bit per direction, see dirX/dirY
+    bool enterable[Cells];
+    
+    unsigned short g[Cells];            // cost so far, in half steps
+    short parent[Cells];
+    unsigned int closed[(Cells + 31) / 32];
+    
+    // open list, entries may be stale and are skipped when popped
+    unsigned int heap[Cells * 8];
+    int heapSize;
+};
+
+#endif /* GridPather_hpp */
@@ -7,20 +7,21 @@
 extern "C" {
     int rogue_main(int argc, const char ** argv);
     int is_rogue_running();
-    void setUpdateConsumers(int c);
 }
 
 #include <pthread.h>
 pthread_t gameThread;
 
-extern char *getScreenData();
-
 // don't change!
 #define TERMINAL_WIDTH 80
 #define TERMINAL_HEIGHT 25
 
+// turns between autosaves, so a run the system kills loses little
+#define AUTOSAVE_TURNS 10
+
 void* gameThreadRoutine(void *arg)
 {
+#ifdef ATROGUE
     const char *argv[] = {
         "rogue",
         "--scr-width=80",
@@ -30,11 +31,34 @@ void* gameThreadRoutine(void *arg)
     };
     
     rogue_main(5,(const char**)argv);
+#else
+    // run on from the autosave if the last run was killed, a new game
+    // if there is none
+    const char *argv[] = {
+        "rogue",
+        "-r",
+    };
+    
+    rogue_main(2,(const char**)argv);
+#endif
     return 0;
 }
 
 int dungeon_main()
 {
+#ifndef ATROGUE
+    // options are read once the game thread starts, set them before;
+    // the save goes where the app may write on every platform
+    std::string opts = "autosave=" + std::to_string(AUTOSAVE_TURNS) +
+        ",file=" + cocos2d::FileUtils::getInstance()->getWritablePath() + "rogue54.sav";
+    if (getenv("ROGUEOPTS") == NULL) {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+        _putenv_s("ROGUEOPTS", opts.c_str());
+#else
+        setenv("ROGUEOPTS", opts.c_str(), 0);
+#endif
+    }
+#endif
     pthread_create(&gameThread, 0, &gameThreadRoutine, (void*)"");
     return 0;
 }
@@ -100,7 +124,6 @@ bool HelloWorld::init()
     this->addChild(gameUI);
 #endif
     
-    setUpdateConsumers(4);
     dungeon_main();
     
     memset(keysDown,0,sizeof(keysDown));
@@ -0,0 +1,176 @@
+//
+//  TerminalGrid.cpp
+//  cc2dxgame
+//
+//
+
+#include "TerminalGrid.hpp"
+
+USING_NS_CC;
+
+// tiles drawn by the map overlap a little to hide seams when zoomed
+#define TILE_SCALE 1.008f
+
+TerminalGrid* TerminalGrid::createWithLayer(TMXLayer *layer)
+{
+    TerminalGrid *grid = new (std::nothrow) TerminalGrid();
+    if (grid && grid->initWithLayer(layer)) {
+        grid->autorelease();
+        return grid;
+    }
+    CC_SAFE_DELETE(grid);
+    return nullptr;
+}
+
+TerminalGrid::TerminalGrid() : Node()
+{
+    cols = 0;
+    rows = 0;
+    tileset = 0;
+    texture = 0;
+    opacityModifyRGB = false;
+}
+
+TerminalGrid::~TerminalGrid()
+{
+    CC_SAFE_RELEASE(tileset);
+    CC_SAFE_RELEASE(texture);
+}
+
+bool TerminalGrid::initWithLayer(TMXLayer *layer)
+{
+    if (!layer || !layer->getTileSet() || !layer->getTexture())
+        return false;
+    
+    cols = layer->getLayerSize().width;
+    rows = layer->getLayerSize().height;
+    tileSize = layer->getMapTileSize();
+    
+    tileset = layer->getTileSet();
+    tileset->retain();
+    texture = layer->getTexture();
+    texture->retain();
+    
+    // same blending and shader a tile Sprite would get from this texture
+    if (texture->hasPremultipliedAlpha()) {
+        blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+        opacityModifyRGB = true;
+    } else {
+        blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
+        opacityModifyRGB = false;
+    }
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, texture));
+    
+    setAnchorPoint(layer->getAnchorPoint());
+    setPosition(layer->getPosition());
+    setContentSize(layer->getContentSize());
+    
+    cells.resize(cols * rows);
+    verts.resize(cols * rows * 4);
+    indices.resize(cols * rows * 6);
+    
+    for(int i=0;i<cols*rows;i++) {
+        indices[i*6 + 0] = i*4 + 0;
+        indices[i*6 + 1] = i*4 + 1;
+        indices[i*6 + 2] = i*4 + 2;
+        indices[i*6 + 3] = i*4 + 3;
+        indices[i*6 + 4] = i*4 + 2;
+        indices[i*6 + 5] = i*4 + 1;
+    }
+    
+    // start from what the layer was showing
+    for(int r=0;r<rows;r++) {
+        for(int c=0;c<cols;c++) {
+            Cell &cell = cells[(r*cols) + c];
+            cell.gid = layer->getTileGIDAt(Vec2(c,r));
+            cell.color = Color3B::WHITE;
+            cell.opacity = layer->getOpacity();
+            cell.visible = cell.gid != 0;
+            updateQuad(c, r, 1.0f);
+        }
+    }
+    
+    return true;
+}
+
+int TerminalGrid::getTileGID(int c, int r)
+{
+    if (c < 0 || r < 0 || c >= cols || r >= rows)
+        return 0;
+    return cells[(r*cols) + c].gid;
+}
+
+void TerminalGrid::setTile(int c, int r, int gid, const Color3B &color, GLubyte opacity, bool visible)
+{
+    if (c < 0 || r < 0 || c >= cols || r >= rows)
+        return;
+    
+    Cell &cell = cells[(r*cols) + c];
+    if (cell.gid == gid && cell.color == color && cell.opacity == opacity && cell.visible == visible)
+        return;
+    
+    cell.gid = gid;
+    cell.color = color;
+    cell.opacity = opacity;
+    cell.visible = visible;
+    updateQuad(c, r, TILE_SCALE);
+}
+
+void TerminalGrid::updateQuad(int c, int r, float scale)
+{
+    Cell &cell = cells[(r*cols) + c];
+    V3F_C4B_T2F *quad = &verts[((r*cols) + c) * 4];
+    
+    // hidden tiles collapse to a point
+    if (!cell.visible || cell.gid == 0) {
+        memset(quad, 0, sizeof(V3F_C4B_T2F) * 4);
+        return;
+    }
+    
+    // position and texture rect as TMXLayer would set up the tile Sprite
+    Rect rect = tileset->getRectForGID(cell.gid);
+    Size sz = CC_SIZE_PIXELS_TO_POINTS(rect.size) * scale;
+    Vec2 pos = CC_POINT_PIXELS_TO_POINTS(Vec2(c * tileSize.width, (rows - r - 1) * tileSize.height));
+    
+    float aw = texture->getPixelsWide();
+    float ah = texture->getPixelsHigh();
+    float left = rect.origin.x / aw;
+    float right = (rect.origin.x + rect.size.width) / aw;
+    float top = rect.origin.y / ah;
+    float bottom = (rect.origin.y + rect.size.height) / ah;
+    
+    Color4B clr(cell.color.r, cell.color.g, cell.color.b, cell.opacity);
+    if (opacityModifyRGB) {
+        clr.r *= cell.opacity/255.0f;
+        clr.g *= cell.opacity/255.0f;
+        clr.b *= cell.opacity/255.0f;
+    }
+    
+    // top left, bottom left, top right, bottom right
+    quad[0].vertices = Vec3(pos.x, pos.y + sz.height, 0);
+    quad[0].texCoords = Tex2F(left, top);
+    quad[1].vertices = Vec3(pos.x, pos.y, 0);
+    quad[1].texCoords = Tex2F(left, bottom);
+    quad[2].vertices = Vec3(pos.x + sz.width, pos.y + sz.height, 0);
+    quad[2].texCoords = Tex2F(right, top);
+    quad[3].vertices = Vec3(pos.x + sz.width, pos.y, 0);
+    quad[3].texCoords = Tex2F(right, bottom);
+    for(int i=0;i<4;i++) {
+        quad[i].colors = clr;
+    }
+}
+
+void TerminalGrid::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    if (cells.empty())
+        return;
+    
+    TrianglesCommand::Triangles triangles;
+    triangles.verts = verts.data();
+    triangles.vertCount = (int)verts.size();
+    triangles.indices = indices.data();
+    triangles.indexCount = (int)indices.size();
+    
+    command.init(_globalZOrder, texture, getGLProgramState(), blendFunc, triangles, transform, flags);
+    renderer->addCommand(&command);
+}
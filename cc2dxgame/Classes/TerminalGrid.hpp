@@ -0,0 +1,57 @@
+//
+//  TerminalGrid.hpp
+//  cc2dxgame
+//
+//
+
+#ifndef TerminalGrid_hpp
+#define TerminalGrid_hpp
+
+#include "cocos2d.h"
+
+// draws a whole TMX layer worth of tiles as one quad mesh and one
+// TrianglesCommand, instead of a Sprite per touched tile
+class TerminalGrid : public cocos2d::Node
+{
+public:
+    
+    static TerminalGrid* createWithLayer(cocos2d::TMXLayer *layer);
+    
+    bool initWithLayer(cocos2d::TMXLayer *layer);
+    
+    int getTileGID(int c, int r);
+    void setTile(int c, int r, int gid, const cocos2d::Color3B &color, GLubyte opacity, bool visible);
+    
+    virtual void draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags) override;
+    
+protected:
+    
+    TerminalGrid();
+    virtual ~TerminalGrid();
+    
+    struct Cell {
+        int gid;
+        cocos2d::Color3B color;
+        GLubyte opacity;
+        bool visible;
+    };
+    
+    void updateQuad(int c, int r, float scale);
+    
+    int cols;
+    int rows;
+    cocos2d::Size tileSize;
+    
+    cocos2d::TMXTilesetInfo *tileset;
+    cocos2d::Texture2D *texture;
+    cocos2d::BlendFunc blendFunc;
+    bool opacityModifyRGB;
+    
+    std::vector<Cell> cells;
+    std::vector<cocos2d::V3F_C4B_T2F> verts;
+    std::vector<unsigned short> indices;
+    
+    cocos2d::TrianglesCommand command;
+};
+
+#endif /* TerminalGrid_hpp */
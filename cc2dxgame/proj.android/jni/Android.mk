@@ -18,6 +18,9 @@ LOCAL_SRC_FILES := hellocpp/main.cpp \
 		../../Classes/HelloWorldScene.cpp \
 		../../Classes/CursesTileMap.cpp \
 		../../Classes/GraphicsTileMap.cpp \
+		../../Classes/DistanceField.cpp \
+		../../Classes/GridPather.cpp \
+		../../Classes/TerminalGrid.cpp \
 		../../Classes/GameInterface.cpp \
 		../../Classes/micropather.cpp \
 		../../../rogue-5.4/armor.c \
@@ -30,6 +33,7 @@ LOCAL_SRC_FILES := hellocpp/main.cpp \
 		../../../rogue-5.4/init.c \
 		../../../rogue-5.4/io.c \
 		../../../rogue-5.4/list.c \
+		../../../rogue-5.4/journal.c \
 		../../../rogue-5.4/mach_dep.c \
 		../../../rogue-5.4/rogue_main.c \
 		../../../rogue-5.4/mdport.c \
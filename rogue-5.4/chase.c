@@ -16,7 +16,80 @@
 
 #define DRAGONSHOT  5	/* one chance in DRAGONSHOT that a dragon will flame */
 
-static coord ch_ret;				/* Where chasing takes you */
+#define FLOW_FAR    32767	/* the flow field does not reach this spot */
+
+static TLOCAL coord ch_ret;				/* Where chasing takes you */
+static TLOCAL short flow[NUMLINES][NUMCOLS];		/* Steps to the hero */
+static TLOCAL int flow_valid = FALSE;			/* flow[] is for this turn */
+
+/*
+ * flow_build:
+ *	Count the steps from the hero to every spot a monster can walk
+ *	on, once a turn for all the runners to share.  Scare monster
+ *	scrolls and Xerocs are marked off first, so nobody plans a way
+ *	through them
+ */
+static void
+flow_build(void)
+{
+    static const int dy[] = { -1, 0, 1, 0, -1, -1, 1, 1 };
+    static const int dx[] = { 0, 1, 0, -1, -1, 1, -1, 1 };
+    static TLOCAL char blocked[NUMLINES][NUMCOLS];
+    static TLOCAL coord queue[NUMLINES * NUMCOLS];
+    THING *tp;
+    coord cp, np;
+    int head, tail, d, y, x;
+
+    for (y = 0; y < NUMLINES; y++)
+	for (x = 0; x < NUMCOLS; x++)
+	{
+	    flow[y][x] = FLOW_FAR;
+	    blocked[y][x] = FALSE;
+	}
+    for (tp = lvl_obj; tp != NULL; tp = next(tp))
+	if (tp->o_type == SCROLL && tp->o_which == S_SCARE)
+	    blocked[tp->o_pos.y][tp->o_pos.x] = TRUE;
+    for (tp = mlist; tp != NULL; tp = next(tp))
+	if (tp->t_type == 'X')
+	    blocked[tp->t_pos.y][tp->t_pos.x] = TRUE;
+    /*
+     * Nothing may step where the hero stands, so there is no field
+     * to follow this turn
+     */
+    flow_valid = !blocked[hero.y][hero.x];
+    if (!flow_valid)
+	return;
+    flow[hero.y][hero.x] = 0;
+    queue[0] = hero;
+    head = 0;
+    tail = 1;
+    while (head < tail)
+    {
+	cp = queue[head++];
+	for (d = 0; d < 8; d++)
+	{
+	    np.y = cp.y + dy[d];
+	    np.x = cp.x + dx[d];
+	    if (!diag_ok(&cp, &np) || flow[np.y][np.x] != FLOW_FAR
+		|| blocked[np.y][np.x] || !step_ok(chat(np.y, np.x)))
+		    continue;
+	    flow[np.y][np.x] = flow[cp.y][cp.x] + 1;
+	    queue[tail++] = np;
+	}
+    }
+}
+
+/*
+ * flow_chases:
+ *	Should this monster follow the flow field instead of heading
+ *	for doors
+ */
+static int
+flow_chases(const THING *tp)
+{
+    return (flow_chase && flow_valid && tp->t_dest == &hero
+	&& flow[tp->t_pos.y][tp->t_pos.x] != FLOW_FAR);
+}
 
 /*
  * runners:
@@ -30,6 +103,8 @@ runners(void)
     int wastarget;
     coord orig_pos;
 
+    if (flow_chase)
+	flow_build();
     for (tp = mlist; tp != NULL; tp = next)
     {
         /* remember this in case the monster's "next" is changed */
@@ -49,6 +124,7 @@ runners(void)
 	    }
 	}
     }
+    flow_valid = FALSE;
     if (has_hit)
     {
 	endmsg();
@@ -136,10 +212,10 @@ do_chase(THING *th)
     /*
      * If the object of our desire is in a different room,
      * and we are not in a corridor, run to the door nearest to
-     * our goal.
+     * our goal.  The flow field already knows the way to the hero.
      */
 over:
-    if (rer != ree)
+    if (rer != ree && !flow_chases(th))
     {
 	for (cp = rer->r_exit; cp < &rer->r_exit[rer->r_nexits]; cp++)
 	{
@@ -165,7 +241,8 @@ over:
 	 * line from it, and (b) that it is within shooting distance,
 	 * but outside of striking range.
 	 */
-	if (th->t_type == 'D' && (th->t_pos.y == hero.y || th->t_pos.x == hero.x
+	if (th->t_type == 'D' && rer == ree
+	    && (th->t_pos.y == hero.y || th->t_pos.x == hero.x
 	    || abs(th->t_pos.y - hero.y) == abs(th->t_pos.x - hero.x))
 	    && dist_cp(&th->t_pos, &hero) <= BOLT_LENGTH * BOLT_LENGTH
 	    && !on(*th, ISCANC) && rnd(DRAGONSHOT) == 0)
@@ -199,16 +276,15 @@ over:
 	}
 	else if (ce(this, *th->t_dest))
 	{
-	    for (obj = lvl_obj; obj != NULL; obj = next(obj))
-		if (th->t_dest == &obj->o_pos)
-		{
-		    detach(lvl_obj, obj);
-		    attach(th->t_pack, obj);
-		    chat(obj->o_pos.y, obj->o_pos.x) =
-			(th->t_room->r_flags & ISGONE) ? PASSAGE : FLOOR;
-		    th->t_dest = find_dest(th);
-		    break;
-		}
+	    obj = objat(this.y, this.x);
+	    if (obj != NULL && th->t_dest == &obj->o_pos)
+	    {
+		detach(lvl_obj, obj);
+		attach(th->t_pack, obj);
+		chat(obj->o_pos.y, obj->o_pos.x) =
+		    (th->t_room->r_flags & ISGONE) ? PASSAGE : FLOOR;
+		th->t_dest = find_dest(th);
+	    }
 	    if (th->t_type != 'F')
 		stoprun = TRUE;
 	}
@@ -342,6 +418,40 @@ chase(THING *tp, const coord *ee)
 	if (rnd(20) == 0)
 	    tp->t_flags &= ~ISHUH;
     }
+    /*
+     * Going for the hero with the flow field, move to the free spot
+     * next to the chaser that is fewest steps from him
+     */
+    else if (ce(*ee, hero) && flow_chases(tp))
+    {
+	int ey, ex;
+
+	thisdist = flow[er->y][er->x];
+	ch_ret = *er;
+
+	ey = er->y + 1;
+	ex = er->x + 1;
+	for (x = er->x - 1; x <= ex; x++)
+	{
+	    tryp.x = x;
+	    for (y = er->y - 1; y <= ey; y++)
+	    {
+		tryp.y = y;
+		if (!diag_ok(er, &tryp) || flow[y][x] > thisdist
+		    || !step_ok(winat(y, x)))
+			continue;
+		if (flow[y][x] < thisdist)
+		{
+		    plcnt = 1;
+		    ch_ret = tryp;
+		    thisdist = flow[y][x];
+		}
+		else if (!ce(ch_ret, *er) && rnd(++plcnt) == 0)
+		    ch_ret = tryp;
+	    }
+	}
+	curdist = dist_cp(&ch_ret, ee);
+    }
     /*
      * Otherwise, find the empty spot next to the chaser that is
      * closest to the chasee.
@@ -382,11 +492,7 @@ chase(THING *tp, const coord *ee)
 		     */
 		    if (ch == SCROLL)
 		    {
-			for (obj = lvl_obj; obj != NULL; obj = next(obj))
-			{
-			    if (y == obj->o_pos.y && x == obj->o_pos.x)
-				break;
-			}
+			obj = objat(y, x);
 			if (obj != NULL && obj->o_which == S_SCARE)
 			    continue;
 		    }
@@ -427,7 +533,7 @@ struct room *
 roomin(const coord *cp)
 {
     struct room *rp;
-    int *fp;
+    pflag_t *fp;
 
     fp = &flat(cp->y, cp->x);
     if (*fp & F_PASS)
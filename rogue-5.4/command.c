@@ -25,10 +25,11 @@ command(void)
 {
     int ch;
     int ntimes = 1;			/* Number of player moves */
-    int *fp;
+    pflag_t *fp;
     THING *mp;
-    static int countch, direction, newcount = FALSE;
+    static TLOCAL int countch, direction, newcount = FALSE;
 
+    turns++;
     if (on(player, ISHASTE))
 	ntimes++;
     /*
@@ -51,13 +52,24 @@ command(void)
 	if (on(player, ISSLOW|ISGREED|ISINVIS|ISREGEN|ISTARGET))
 	    exit(1);
 
+#ifdef DEBUG
+	check_objs();
+#endif
 	look(TRUE);
+	if (travelling && running && (runch = travel_dir()) == 0)
+	    running = FALSE;
 	if (!running)
-	    door_stop = FALSE;
+	    door_stop = travelling = FALSE;
 	status();
+	show_hero();
 	lastscore = purse;
 	move(hero.y, hero.x);
-	if (!((running || count) && jump))
+	if (travelling)
+	{
+	    if (travel_draw > 0 && travel_steps++ % travel_draw == 0)
+		refresh();
+	}
+	else if (!((running || count) && jump))
 	    refresh();			/* Draw screen */
 	take = 0;
 	after = TRUE;
@@ -156,18 +168,9 @@ over:
 	    switch (ch)
 	    {
 		case ',': {
-		    THING *obj = NULL;
-		    int found = 0;
-		    for (obj = lvl_obj; obj != NULL; obj = next(obj))
-    			{
-			    if (obj->o_pos.y == hero.y && obj->o_pos.x == hero.x)
-			    {
-				found=1;
-				break;
-			    }
-    			}
+		    THING *obj = objat(hero.y, hero.x);
 
-		    if (found) {
+		    if (obj != NULL) {
 			if (levit_check())
 			    ;
 			else
@@ -199,6 +202,7 @@ over:
 		when 'U': do_run('u');
 		when 'B': do_run('b');
 		when 'N': do_run('n');
+		when TRAVEL: do_travel();
 		when CTRL('H'): case CTRL('J'): case CTRL('K'): case CTRL('L'):
 		case CTRL('Y'): case CTRL('U'): case CTRL('B'): case CTRL('N'):
 		{
@@ -447,7 +451,7 @@ over:
 	    pick_up(take);
 	if (!running)
 	    door_stop = FALSE;
-	if (!after)
+	if (!after && playing)
 	    ntimes++;
     }
     do_daemons(AFTER);
@@ -460,6 +464,7 @@ over:
 	search();
     else if (ISRING(RIGHT, R_TELEPORT) && rnd(50) == 0)
 	teleport();
+    autosave();
 }
 
 /*
@@ -483,7 +488,7 @@ void
 search(void)
 {
     int y, x;
-    int *fp;
+    pflag_t *fp;
     int ey, ex;
     int probinc;
     int found;
@@ -598,8 +603,10 @@ help(void)
 	}
     wmove(hw, LINES - 1, 0);
     waddstr(hw, "--Press space to continue--");
+    show_menu(TRUE);
     wrefresh(hw);
     wait_for(hw, ' ');
+    show_menu(FALSE);
     clearok(stdscr, TRUE);
 /*
     refresh();
@@ -642,6 +649,7 @@ identify(void)
     };
 
     msg("what do you want identified? ");
+    show_prompt(PR_IDENTIFY);
     ch = readchar();
     mpos = 0;
     if (ch == ESCAPE)
@@ -785,6 +793,7 @@ norm:
 	msg("call it: ");
     else
 	msg("what do you want to call it? ");
+    show_prompt(PR_NAME);
 
     if (elsewise == NULL)
 	strcpy(prbuf, "");
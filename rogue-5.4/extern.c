@@ -15,68 +15,75 @@
 #include <curses.h>
 #include "rogue.h"
 
-int  after;				/* True if we want after daemons */
-int  again;				/* Repeating the last command */
-int  noscore;				/* Was a wizard sometime */
-int  seenstairs;			/* Have seen the stairs (for lsd) */
-int  amulet = FALSE;			/* He found the amulet */
-int  door_stop = FALSE;			/* Stop running when we pass a door */
-int  fight_flush = FALSE;		/* True if toilet input */
-int  firstmove = FALSE;			/* First move after setting door_stop */
-int  got_ltc = FALSE;			/* We have gotten the local tty chars */
-int  has_hit = FALSE;			/* Has a "hit" message pending in msg */
-int  in_shell = FALSE;			/* True if executing a shell */
-int  inv_describe = TRUE;		/* Say which way items are being used */
-int  jump = FALSE;			/* Show running as series of jumps */
-int  kamikaze = FALSE;			/* to_death really to DEATH */
-int  lower_msg = FALSE;			/* Messages should start w/lower case */
-int  move_on = FALSE;			/* Next move shouldn't pick up items */
-int  msg_esc = FALSE;			/* Check for ESC from msg's --More-- */
-int  passgo = FALSE;			/* Follow passages */
-int  playing = TRUE;			/* True until he quits */
-int  q_comm = FALSE;			/* Are we executing a 'Q' command? */
-int  running = FALSE;			/* True if player is running */
-int  save_msg = TRUE;			/* Remember last msg */
-int  see_floor = TRUE;			/* Show the lamp illuminated floor */
-int  stat_msg = FALSE;			/* Should status() print as a msg() */
-int  terse = FALSE;				/* True if we should be short */
-int  to_death = FALSE;			/* Fighting is to the death! */
-int  tombstone = TRUE;			/* Print out tombstone at end */
+TLOCAL int  after;			/* True if we want after daemons */
+TLOCAL int  again;			/* Repeating the last command */
+TLOCAL int  noscore;			/* Was a wizard sometime */
+TLOCAL int  seenstairs;			/* Have seen the stairs (for lsd) */
+TLOCAL int  amulet = FALSE;		/* He found the amulet */
+TLOCAL int  digging = FALSE;		/* This thread only digs levels */
+TLOCAL int  door_stop = FALSE;		/* Stop running when we pass a door */
+TLOCAL int  fight_flush = FALSE;	/* True if toilet input */
+TLOCAL int  flow_chase = FALSE;		/* Monsters follow a flow field to her */
+TLOCAL int  firstmove = FALSE;		/* First move after setting door_stop */
+TLOCAL int  got_ltc = FALSE;		/* We have gotten the local tty chars */
+TLOCAL int  has_hit = FALSE;		/* Has a "hit" message pending in msg */
+TLOCAL int  in_shell = FALSE;		/* True if executing a shell */
+TLOCAL int  inv_describe = TRUE;	/* Say which way items are being used */
+TLOCAL int  jump = FALSE;		/* Show running as series of jumps */
+TLOCAL int  kamikaze = FALSE;		/* to_death really to DEATH */
+TLOCAL int  lower_msg = FALSE;		/* Messages should start w/lower case */
+TLOCAL int  move_on = FALSE;		/* Next move shouldn't pick up items */
+TLOCAL int  msg_esc = FALSE;		/* Check for ESC from msg's --More-- */
+TLOCAL int  passgo = FALSE;		/* Follow passages */
+TLOCAL int  playing = TRUE;		/* True until he quits */
+TLOCAL int  q_comm = FALSE;		/* Are we executing a 'Q' command? */
+TLOCAL int  running = FALSE;		/* True if player is running */
+TLOCAL int  save_msg = TRUE;		/* Remember last msg */
+TLOCAL int  see_floor = TRUE;		/* Show the lamp illuminated floor */
+TLOCAL int  stat_msg = FALSE;		/* Should status() print as a msg() */
+TLOCAL int  terse = FALSE;			/* True if we should be short */
+TLOCAL int  to_death = FALSE;		/* Fighting is to the death! */
+TLOCAL int  tombstone = TRUE;		/* Print out tombstone at end */
+TLOCAL int  travelling = FALSE;		/* Running is heading for travel_dest */
 #ifdef MASTER
-int  wizard = FALSE;			/* True if allows wizard commands */
+TLOCAL int  wizard = FALSE;		/* True if allows wizard commands */
 #endif
-int  pack_used[26] = {			/* Is the character used in the pack? */
+TLOCAL int  pack_used[26] = {		/* Is the character used in the pack? */
     FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE,
     FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE,
     FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE, FALSE
 };
 
-int  dir_ch;				/* Direction from last get_dir() call */
-char file_name[MAXSTR];			/* Save file name */
-char huh[MAXSTR];			/* The last message printed */
-const char *p_colors[MAXPOTIONS];		/* Colors of the potions */
-char prbuf[2*MAXSTR];			/* buffer for sprintfs */
-const char *r_stones[MAXRINGS];		/* Stone settings of the rings */
-int  runch;				/* Direction player is running */
-char *s_names[MAXSCROLLS];		/* Names of the scrolls */
-int  take;				/* Thing she is taking */
-char whoami[MAXSTR];			/* Name of player */
-const char *ws_made[MAXSTICKS];		/* What sticks are made of */
-char *ws_type[MAXSTICKS];		/* Is it a wand or a staff */
-int  orig_dsusp;			/* Original dsusp char */
-char fruit[MAXSTR] =			/* Favorite fruit */
+TLOCAL int  dir_ch;			/* Direction from last get_dir() call */
+TLOCAL char file_name[MAXSTR];		/* Save file name */
+TLOCAL char huh[MAXSTR];		/* The last message printed */
+TLOCAL const char *p_colors[MAXPOTIONS];	/* Colors of the potions */
+TLOCAL char prbuf[2*MAXSTR];		/* buffer for sprintfs */
+TLOCAL char rogue_opts[MAXSTR];		/* ROGUEOPTS, or a replay's options */
+TLOCAL const char *r_stones[MAXRINGS];	/* Stone settings of the rings */
+TLOCAL int  runch;			/* Direction player is running */
+TLOCAL char *s_names[MAXSCROLLS];	/* Names of the scrolls */
+TLOCAL int  take;			/* Thing she is taking */
+TLOCAL int  travel_draw = 1;		/* Steps between frames when travelling */
+TLOCAL int  autosave_turns = 0;		/* Turns between autosaves, 0 for none */
+TLOCAL int  travel_steps;		/* Steps taken on this travel */
+TLOCAL char whoami[MAXSTR];		/* Name of player */
+TLOCAL const char *ws_made[MAXSTICKS];	/* What sticks are made of */
+TLOCAL char *ws_type[MAXSTICKS];	/* Is it a wand or a staff */
+TLOCAL int  orig_dsusp;			/* Original dsusp char */
+TLOCAL char fruit[MAXSTR] =		/* Favorite fruit */
 		{ 's', 'l', 'i', 'm', 'e', '-', 'm', 'o', 'l', 'd', '\0' };
-char home[MAXSTR] = { '\0' };		/* User's home directory */
-const char *inv_t_name[] = {
+TLOCAL char home[MAXSTR] = { '\0' };	/* User's home directory */
+TLOCAL const char *inv_t_name[] = {
 	"Overwrite",
 	"Slow",
 	"Clear"
 };
-int  l_last_comm = '\0';		/* Last last_comm */
-int  l_last_dir = '\0';			/* Last last_dir */
-int  last_comm = '\0';			/* Last command typed */
-int  last_dir = '\0';			/* Last direction given */
-const char *tr_name[] = {			/* Names of the traps */
+TLOCAL int  l_last_comm = '\0';		/* Last last_comm */
+TLOCAL int  l_last_dir = '\0';		/* Last last_dir */
+TLOCAL int  last_comm = '\0';		/* Last command typed */
+TLOCAL int  last_dir = '\0';		/* Last direction given */
+TLOCAL const char *tr_name[] = {		/* Names of the traps */
 	"a trapdoor",
 	"an arrow trap",
 	"a sleeping gas trap",
@@ -88,16 +95,16 @@ const char *tr_name[] = {			/* Names of the traps */
 };
 
 
-int n_objs;				/* # items listed in inventory() call */
-int ntraps;				/* Number of traps on this level */
-int hungry_state = 0;			/* How hungry is he */
-int inpack = 0;				/* Number of things in pack */
-int inv_type = 0;			/* Type of inventory to use */
-int level = 1;				/* What level she is on */
-int max_hit;				/* Max damage done to her in to_death */
-int max_level;				/* Deepest player has gone */
-int mpos = 0;				/* Where cursor is on top line */
-int no_food = 0;			/* Number of levels without food */
+TLOCAL int n_objs;			/* # items listed in inventory() call */
+TLOCAL int ntraps;			/* Number of traps on this level */
+TLOCAL int hungry_state = 0;		/* How hungry is he */
+TLOCAL int inpack = 0;			/* Number of things in pack */
+TLOCAL int inv_type = 0;		/* Type of inventory to use */
+TLOCAL int level = 1;			/* What level she is on */
+TLOCAL int max_hit;			/* Max damage done to her in to_death */
+TLOCAL int max_level;			/* Deepest player has gone */
+TLOCAL int mpos = 0;			/* Where cursor is on top line */
+TLOCAL int no_food = 0;			/* Number of levels without food */
 const int a_class[MAXARMORS] = {		/* Armor class for each armor type */
 	8,	/* LEATHER */
 	7,	/* RING_MAIL */
@@ -109,18 +116,19 @@ const int a_class[MAXARMORS] = {		/* Armor class for each armor type */
 	3,	/* PLATE_MAIL */
 };
 
-int count = 0;				/* Number of times to repeat command */
-FILE *scoreboard = NULL;		/* File descriptor for score file */
-int food_left;				/* Amount of food in hero's stomach */
-int lastscore = -1;			/* Score before this turn */
-int no_command = 0;			/* Number of turns asleep */
-int no_move = 0;			/* Number of turns held in place */
-int purse = 0;				/* How much gold he has */
-int quiet = 0;				/* Number of quiet turns */
-int vf_hit = 0;				/* Number of time flytrap has hit */
+TLOCAL int count = 0;			/* Number of times to repeat command */
+TLOCAL FILE *scoreboard = NULL;		/* File descriptor for score file */
+TLOCAL int food_left;			/* Amount of food in hero's stomach */
+TLOCAL int lastscore = -1;		/* Score before this turn */
+TLOCAL int no_command = 0;		/* Number of turns asleep */
+TLOCAL int no_move = 0;			/* Number of turns held in place */
+TLOCAL int purse = 0;			/* How much gold he has */
+TLOCAL int quiet = 0;			/* Number of quiet turns */
+TLOCAL int turns = 0;			/* Number of turns played */
+TLOCAL int vf_hit = 0;			/* Number of time flytrap has hit */
 
-unsigned int dnum;				/* Dungeon number */
-unsigned int seed;				/* Random number seed */
+TLOCAL unsigned int dnum;			/* Dungeon number */
+TLOCAL unsigned int seed;			/* Random number seed */
 const int e_levels[] = {
         10L,
 	20L,
@@ -145,31 +153,39 @@ const int e_levels[] = {
 	 0L
 };
 
-coord delta;				/* Change indicated to get_dir() */
-coord oldpos;				/* Position before last look() call */
-coord stairs;				/* Location of staircase */
+TLOCAL coord delta;			/* Change indicated to get_dir() */
+TLOCAL coord oldpos;			/* Position before last look() call */
+TLOCAL coord stairs;			/* Location of staircase */
+TLOCAL coord travel_dest;		/* Where the hero is travelling to */
 
-PLACE places[MAXLINES*MAXCOLS];		/* level map */
+#ifdef PLACES_SOA
+TLOCAL unsigned char place_ch[MAXLINES*MAXCOLS];	/* level map, row by row */
+TLOCAL pflag_t place_flags[MAXLINES*MAXCOLS];
+TLOCAL THING *place_monst[MAXLINES*MAXCOLS];
+TLOCAL THING *place_obj[MAXLINES*MAXCOLS];
+#else
+TLOCAL PLACE places[MAXLINES*MAXCOLS];	/* level map */
+#endif
 
-THING *cur_armor;			/* What he is wearing */
-THING *cur_ring[2];			/* Which rings are being worn */
-THING *cur_weapon;			/* Which weapon he is weilding */
-THING *l_last_pick = NULL;		/* Last last_pick */
-THING *last_pick = NULL;		/* Last object picked in get_item() */
-THING *lvl_obj = NULL;			/* List of objects on this level */
-THING *mlist = NULL;			/* List of monsters on the level */
-THING player;				/* His stats */
+TLOCAL THING *cur_armor;		/* What he is wearing */
+TLOCAL THING *cur_ring[2];		/* Which rings are being worn */
+TLOCAL THING *cur_weapon;		/* Which weapon he is weilding */
+TLOCAL THING *l_last_pick = NULL;	/* Last last_pick */
+TLOCAL THING *last_pick = NULL;		/* Last object picked in get_item() */
+TLOCAL THING *lvl_obj = NULL;		/* List of objects on this level */
+TLOCAL THING *mlist = NULL;		/* List of monsters on the level */
+TLOCAL THING player;			/* His stats */
 					/* restart of game */
 
-WINDOW *hw = NULL;			/* used as a scratch window */
+TLOCAL WINDOW *hw = NULL;		/* used as a scratch window */
 
 #define INIT_STATS { 16, 0, 1, 10, 12, "1x4", 12 }
 
-struct stats max_stats = INIT_STATS;	/* The maximum for the player */
+TLOCAL struct stats max_stats = INIT_STATS;	/* The maximum for the player */
 
-struct room *oldrp;			/* Roomin(&oldpos) */
-struct room rooms[MAXROOMS];		/* One for each room -- A level */
-struct room passages[MAXPASS] =		/* One for each passage */
+TLOCAL struct room *oldrp;		/* Roomin(&oldpos) */
+TLOCAL struct room rooms[MAXROOMS];	/* One for each room -- A level */
+TLOCAL struct room passages[MAXPASS] =	/* One for each passage */
 {
     { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
     { {0, 0}, {0, 0}, {0, 0}, 0, ISGONE|ISDARK, 0, {{0,0}} },
@@ -187,7 +203,7 @@ struct room passages[MAXPASS] =		/* One for each passage */
 
 #define ___ 1
 #define XX 10
-struct monster monsters[26] =
+TLOCAL struct monster monsters[26] =
     {
 /* Name		 CARRY	FLAG    str, exp, lvl, amr, hpt, dmg */
 { "aquator",	   0,	ISMEAN,	{ XX, 20,   5,   2, ___, "0x0/0x0" } },
@@ -222,7 +238,7 @@ struct monster monsters[26] =
 #undef ___
 #undef XX
 
-struct obj_info things[NUMTHINGS] = {
+TLOCAL struct obj_info things[NUMTHINGS] = {
     { 0,			26 },	/* potion */
     { 0,			36 },	/* scroll */
     { 0,			16 },	/* food */
@@ -232,7 +248,7 @@ struct obj_info things[NUMTHINGS] = {
     { 0,			 4 },	/* stick */
 };
 
-struct obj_info arm_info[MAXARMORS] = {
+TLOCAL struct obj_info arm_info[MAXARMORS] = {
     { "leather armor",		 20,	 20, NULL, FALSE },
     { "ring mail",		 15,	 25, NULL, FALSE },
     { "studded leather armor",	 15,	 20, NULL, FALSE },
@@ -242,7 +258,7 @@ struct obj_info arm_info[MAXARMORS] = {
     { "banded mail",		 10,	 90, NULL, FALSE },
     { "plate mail",		  5,	150, NULL, FALSE },
 };
-struct obj_info pot_info[MAXPOTIONS] = {
+TLOCAL struct obj_info pot_info[MAXPOTIONS] = {
     { "confusion",		 7,   5, NULL, FALSE },
     { "hallucination",		 8,   5, NULL, FALSE },
     { "poison",			 8,   5, NULL, FALSE },
@@ -258,7 +274,7 @@ struct obj_info pot_info[MAXPOTIONS] = {
     { "blindness",		 5,   5, NULL, FALSE },
     { "levitation",		 6,  75, NULL, FALSE },
 };
-struct obj_info ring_info[MAXRINGS] = {
+TLOCAL struct obj_info ring_info[MAXRINGS] = {
     { "protection",		 9, 400, NULL, FALSE },
     { "add strength",		 9, 400, NULL, FALSE },
     { "sustain strength",	 5, 280, NULL, FALSE },
@@ -274,7 +290,7 @@ struct obj_info ring_info[MAXRINGS] = {
     { "stealth",		 7, 470, NULL, FALSE },
     { "maintain armor",		 5, 380, NULL, FALSE },
 };
-struct obj_info scr_info[MAXSCROLLS] = {
+TLOCAL struct obj_info scr_info[MAXSCROLLS] = {
     { "monster confusion",		 7, 140, NULL, FALSE },
     { "magic mapping",			 4, 150, NULL, FALSE },
     { "hold monster",			 2, 180, NULL, FALSE },
@@ -294,7 +310,7 @@ struct obj_info scr_info[MAXSCROLLS] = {
     { "aggravate monsters",		 3,  20, NULL, FALSE },
     { "protect armor",			 2, 250, NULL, FALSE },
 };
-struct obj_info weap_info[MAXWEAPONS + 1] = {
+TLOCAL struct obj_info weap_info[MAXWEAPONS + 1] = {
     { "mace",				11,   8, NULL, FALSE },
     { "long sword",			11,  15, NULL, FALSE },
     { "short bow",			12,  15, NULL, FALSE },
@@ -306,7 +322,7 @@ struct obj_info weap_info[MAXWEAPONS + 1] = {
     { "spear",				12,   5, NULL, FALSE },
     { NULL, 0 },	/* DO NOT REMOVE: fake entry for dragon's breath */
 };
-struct obj_info ws_info[MAXSTICKS] = {
+TLOCAL struct obj_info ws_info[MAXSTICKS] = {
     { "light",			12, 250, NULL, FALSE },
     { "invisibility",		 6,   5, NULL, FALSE },
     { "lightning",		 3, 330, NULL, FALSE },
@@ -391,16 +407,16 @@ const struct h_list helpstr[] = {
     {'v',	"	print version number",			TRUE},
     {0,		NULL }
 };
-int numscores;
-char *Numname;
-int allscore;
-int between;
+TLOCAL int numscores;
+TLOCAL char *Numname;
+TLOCAL int allscore;
+TLOCAL int between;
 
 #define _X_ { EMPTY }
 
-struct delayed_action d_list[MAXDAEMONS] = {
+TLOCAL struct delayed_action d_list[MAXDAEMONS] = {
     _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_,
     _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, _X_, 
 };
 
-int group = 2;
+TLOCAL int group = 2;
@@ -112,6 +112,15 @@ typedef unsigned int pid_t;
 #define MAXLINES	32	/* maximum number of screen lines used */
 #define MAXCOLS		80	/* maximum number of screen columns used */
 
+/*
+ * With PDC_THREADS each thread keeps its own game, see ROGUE_CONTEXT
+ */
+#ifdef PDC_THREADS
+#define TLOCAL		__thread
+#else
+#define TLOCAL
+#endif
+
 #define RN		(((seed = seed*11109+13849) >> 16) & 0xffff)
 #ifdef CTRL
 #undef CTRL
@@ -122,14 +131,14 @@ typedef unsigned int pid_t;
  * Now all the global variables
  */
 
-extern int got_ltc, in_shell;
-extern int	wizard;
-extern char	fruit[], prbuf[], whoami[];
-extern int orig_dsusp;
-extern FILE	*scoreboard;
-extern int numscores;
-extern char *Numname;
-extern int allscore;
+extern TLOCAL int got_ltc, in_shell;
+extern TLOCAL int	wizard;
+extern TLOCAL char	fruit[], prbuf[], whoami[];
+extern TLOCAL int orig_dsusp;
+extern TLOCAL FILE	*scoreboard;
+extern TLOCAL int numscores;
+extern TLOCAL char *Numname;
+extern TLOCAL int allscore;
 
 /*
  * Function types
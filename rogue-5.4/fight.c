@@ -352,7 +352,7 @@ set_mname(const THING *tp)
 {
     int ch;
     const char *mname;
-    static char tbuf[MAXSTR] = { 't', 'h', 'e', ' ' };
+    static TLOCAL char tbuf[MAXSTR] = { 't', 'h', 'e', ' ' };
 
     if (!see_monst(tp) && !on(player, SEEMONST))
 	return (terse ? "it" : "something");
@@ -487,7 +487,7 @@ roll_em(const THING *thatt, THING *thdef, const THING *weap, int hurl)
 char *
 prname(const char *mname, int upper)
 {
-    static char tbuf[MAXSTR];
+    static TLOCAL char tbuf[MAXSTR];
 
     *tbuf = '\0';
     if (mname == 0)
@@ -648,7 +648,7 @@ killed(THING *tp, int pr)
 
 	    if (fallpos(&tp->t_pos, &tp->t_room->r_gold) && level >= max_level)
 	    {
-		gold = new_item();
+		gold = new_lvl_item();
 		gold->o_type = GOLD;
 		gold->o_goldval = GOLDCALC;
 		if (save(VS_MAGIC))
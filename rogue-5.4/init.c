@@ -225,10 +225,10 @@ const char *metal[] = {
 
 #define NMETAL (sizeof metal / sizeof (char *))
 
-int cNWOOD = NWOOD;
-int cNMETAL = NMETAL;
-int cNSTONES = NSTONES;
-int cNCOLORS = NCOLORS;
+TLOCAL int cNWOOD = NWOOD;
+TLOCAL int cNMETAL = NMETAL;
+TLOCAL int cNSTONES = NSTONES;
+TLOCAL int cNCOLORS = NCOLORS;
 
 /*
  * init_colors:
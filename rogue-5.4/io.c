@@ -16,8 +16,8 @@
  */
 #define MAXMSG	(NUMCOLS - sizeof "--More--")
 
-static char msgbuf[2*MAXMSG+1];
-static int newpos = 0;
+static TLOCAL char msgbuf[2*MAXMSG+1];
+static TLOCAL int newpos = 0;
 
 /* VARARGS1 */
 int
@@ -33,6 +33,7 @@ msg(const char *fmt, ...)
 	move(0, 0);
 	clrtoeol();
 	mpos = 0;
+	show_msg("");
 	return ~ESCAPE;
     }
     /*
@@ -75,6 +76,7 @@ endmsg(void)
     {
 	look(FALSE);
 	mvaddstr(0, mpos, "--More--");
+	show_prompt(PR_MORE);
 	refresh();
 	if (!msg_esc)
 	    wait_for(stdscr, ' ');
@@ -99,6 +101,7 @@ endmsg(void)
 	msgbuf[0] = (char) toupper(msgbuf[0]);
     mvaddstr(0, 0, msgbuf);
     clrtoeol();
+    show_msg(msgbuf);
     mpos = newpos;
     newpos = 0;
     msgbuf[0] = '\0';
@@ -113,7 +116,7 @@ endmsg(void)
 void
 doadd(const char *fmt, va_list args)
 {
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     /*
      * Do the printf into buf
@@ -153,7 +156,16 @@ readchar(void)
 {
     int ch;
 
-    ch = md_readchar(stdscr);
+    if (!playing)		/* the game is over, don't ask */
+	return ESCAPE;
+
+    ch = jnl_readchar(stdscr);
+
+    if (ch == KEY_EXIT)		/* nobody is left to type */
+    {
+	my_exit(0);
+	return ESCAPE;
+    }
 
     if (ch == 3)
     {
@@ -193,14 +205,15 @@ void
 status(void)
 {
     int oy, ox, temp;
-    static int hpwidth = 0;
-    static int s_hungry = 0;
-    static int s_lvl = 0;
-    static int s_pur = -1;
-    static int s_hp = 0;
-    static int s_arm = 0;
-    static int s_str = 0;
-    static int s_exp = 0;
+    char buf[MAXSTR];
+    static TLOCAL int hpwidth = 0;
+    static TLOCAL int s_hungry = 0;
+    static TLOCAL int s_lvl = 0;
+    static TLOCAL int s_pur = -1;
+    static TLOCAL int s_hp = 0;
+    static TLOCAL int s_arm = 0;
+    static TLOCAL int s_str = 0;
+    static TLOCAL int s_exp = 0;
     static char *state_name[] =
     {
 	"", "Hungry", "Weak", "Faint"
@@ -239,22 +252,21 @@ status(void)
     s_exp = pstats.s_exp; 
     s_hungry = hungry_state;
 
+    sprintf(buf, "Level: %d  Gold: %-5d  Hp: %*d(%*d)  Str: %2d(%d)  Arm: %-2d  Exp: %d/%d  %s",
+	level, purse, hpwidth, pstats.s_hpt, hpwidth, max_hp, pstats.s_str,
+	max_stats.s_str, 10 - s_arm, pstats.s_lvl, pstats.s_exp,
+	state_name[hungry_state]);
+    show_status(buf);
+
     if (stat_msg)
     {
         move(0, 0);
-        msg("Level: %d  Gold: %-5d  Hp: %*d(%*d)  Str: %2d(%d)  Arm: %-2d  Exp: %d/%d  %s",
-        level, purse, hpwidth, pstats.s_hpt, hpwidth, max_hp, pstats.s_str,
-        max_stats.s_str, 10 - s_arm, pstats.s_lvl, pstats.s_exp,
-        state_name[hungry_state]);
+        msg("%s", buf);
     }
     else
     {
 	move(STATLINE, 0);
-                
-        printw("Level: %d  Gold: %-5d  Hp: %*d(%*d)  Str: %2d(%d)  Arm: %-2d  Exp: %d/%d  %s",
-	    level, purse, hpwidth, pstats.s_hpt, hpwidth, max_hp, pstats.s_str,
-	    max_stats.s_str, 10 - s_arm, pstats.s_lvl, pstats.s_exp,
-	    state_name[hungry_state]);
+        printw("%s", buf);
     }
 
     clrtoeol();
@@ -271,10 +283,10 @@ wait_for(WINDOW *win, int ch)
     int c;
 
     if (ch == '\n')
-        while ((c = wreadchar(win)) != '\n' && c != '\r')
+        while ((c = wreadchar(win)) != '\n' && c != '\r' && playing)
 	    continue;
     else
-        while (wreadchar(win) != ch)
+        while (wreadchar(win) != ch && playing)
 	    continue;
 }
 
@@ -291,8 +303,10 @@ show_win(const char *message)
     wmove(win, 0, 0);
     waddstr(win, message);
     touchwin(win);
+    show_menu(TRUE);
     wrefresh(win);
     wait_for(win, ' ');
+    show_menu(FALSE);
     clearok(curscr, TRUE);
     touchwin(stdscr);
 }
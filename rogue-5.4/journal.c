@@ -0,0 +1,409 @@
+/*
+ * Journal of a game: the seed, the options and every key read, so the
+ * game can be played again exactly as it went
+ *
+ * Rogue: Exploring the Dungeons of Doom
+ * Copyright (C) 1980-1983, 1985, 1999 Michael Toy, Ken Arnold and Glenn Wichman
+ * All rights reserved.
+ *
+ * See the file LICENSE.TXT for full copyright and licensing information.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <curses.h>
+#include "rogue.h"
+
+/*
+ * Each game names its own file to record to or play back, see
+ * rogue_start(); the main game takes it from ROGUEJOURNAL or
+ * ROGUEREPLAY.  The file starts with
+ *
+ *	"RJNL" version seed options-length options
+ *
+ * and is followed by one record per key, appended as the key is read:
+ *
+ *	turn-delta code [args]
+ *
+ * where code is J_KEY + the key, J_TRAVEL y+1 x+1 for a travel target
+ * (0 0 for none), or J_END hash once the game is over.  Numbers are
+ * written seven bits at a time, low bits first, so most keys take two
+ * bytes.
+ */
+#define J_MAGIC		"RJNL"
+#define J_VERSION	1
+
+#define J_END		0
+#define J_TRAVEL	1
+#define J_KEY		2
+
+#define J_CLOSED	0
+#define J_ASKED		1		/* to record, once jnl_start() is called */
+#define J_RECORD	2
+#define J_REPLAY	3
+#define J_ENDED		4		/* replayed to J_END, its hash is next */
+
+bool getTravelTarget(int *y, int *x);
+
+static TLOCAL FILE *jnl_file = NULL;
+static TLOCAL int jnl_mode = J_CLOSED;
+static TLOCAL int jnl_turn = 0;		/* turn of the last record */
+static TLOCAL int jnl_keys = 0;		/* keys recorded or replayed */
+static TLOCAL int jnl_failed = 0;	/* the replay did not match */
+static TLOCAL char jnl_name[MAXSTR];
+
+/*
+ * put_uint:
+ *	Write a number to the journal
+ */
+static void
+put_uint(unsigned int n)
+{
+    while (n >= 0x80)
+    {
+	putc((n & 0x7f) | 0x80, jnl_file);
+	n >>= 7;
+    }
+    putc(n, jnl_file);
+}
+
+/*
+ * get_uint:
+ *	Read a number back, FALSE at the end of the journal
+ */
+static int
+get_uint(unsigned int *np)
+{
+    int c, shift;
+
+    *np = 0;
+    for (shift = 0; shift < 32; shift += 7)
+    {
+	if ((c = getc(jnl_file)) == EOF)
+	    return FALSE;
+	*np |= (unsigned int) (c & 0x7f) << shift;
+	if (!(c & 0x80))
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * hash_num:
+ *	Fold a number into a state hash (FNV-1a)
+ */
+static unsigned int
+hash_num(unsigned int h, int n)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+	h ^= (n >> (i * 8)) & 0xff;
+	h *= 16777619U;
+    }
+    return h;
+}
+
+/*
+ * hash_stats:
+ *	Fold a creature's stats into a state hash
+ */
+static unsigned int
+hash_stats(unsigned int h, const struct stats *sp)
+{
+    h = hash_num(h, sp->s_str);
+    h = hash_num(h, sp->s_exp);
+    h = hash_num(h, sp->s_lvl);
+    h = hash_num(h, sp->s_arm);
+    h = hash_num(h, sp->s_hpt);
+    return hash_num(h, sp->s_maxhp);
+}
+
+/*
+ * state_hash:
+ *	Boil down what the game has come to: the random number stream,
+ *	the hero, the pack, the monsters and the map
+ */
+unsigned int
+state_hash(void)
+{
+    unsigned int h = 2166136261U;
+    THING *tp;
+    int y, x;
+
+    h = hash_num(h, seed);
+    h = hash_num(h, turns);
+    h = hash_num(h, level);
+    h = hash_num(h, purse);
+    h = hash_num(h, food_left);
+    h = hash_num(h, hero.y);
+    h = hash_num(h, hero.x);
+    h = hash_num(h, player.t_flags);
+    h = hash_stats(h, &pstats);
+    h = hash_stats(h, &max_stats);
+    for (tp = pack; tp != NULL; tp = next(tp))
+    {
+	h = hash_num(h, tp->o_type);
+	h = hash_num(h, tp->o_which);
+	h = hash_num(h, tp->o_count);
+	h = hash_num(h, tp->o_flags);
+	h = hash_num(h, tp->o_arm);
+    }
+    for (tp = mlist; tp != NULL; tp = next(tp))
+    {
+	h = hash_num(h, tp->t_type);
+	h = hash_num(h, tp->t_pos.y);
+	h = hash_num(h, tp->t_pos.x);
+	h = hash_num(h, tp->t_flags);
+	h = hash_stats(h, &tp->t_stats);
+    }
+    for (y = 1; y < NUMLINES - 1; y++)
+	for (x = 0; x < NUMCOLS; x++)
+	{
+	    h = hash_num(h, chat(y, x));
+	    h = hash_num(h, flat(y, x));
+	}
+    return h;
+}
+
+/*
+ * jnl_open:
+ *	Get ready to record the game to name, or to play it back from
+ *	there.  A replay sets dnum and rogue_opts to the seed and
+ *	options it was recorded with and returns TRUE
+ */
+int
+jnl_open(const char *name, int replay)
+{
+    char magic[4];
+    unsigned int version, jseed, len;
+
+    jnl_mode = J_CLOSED;
+    jnl_turn = 0;
+    jnl_keys = 0;
+    jnl_failed = 0;
+    if (name == NULL || *name == '\0')
+	return FALSE;
+    strncpy(jnl_name, name, MAXSTR - 1);
+    if (!replay)
+    {
+	jnl_mode = J_ASKED;
+	return FALSE;
+    }
+    if ((jnl_file = fopen(jnl_name, "rb")) == NULL)
+    {
+	perror(jnl_name);
+	return FALSE;
+    }
+    if (fread(magic, 1, 4, jnl_file) != 4
+	|| strncmp(magic, J_MAGIC, 4) != 0
+	|| !get_uint(&version) || version != J_VERSION
+	|| !get_uint(&jseed) || !get_uint(&len) || len >= MAXSTR
+	|| fread(rogue_opts, 1, len, jnl_file) != len)
+    {
+	fprintf(stderr, "%s: not a rogue journal\n", jnl_name);
+	fclose(jnl_file);
+	jnl_file = NULL;
+	rogue_opts[0] = '\0';
+	return FALSE;
+    }
+    rogue_opts[len] = '\0';
+    dnum = jseed;
+    jnl_mode = J_REPLAY;
+    return TRUE;
+}
+
+/*
+ * jnl_start:
+ *	Write the head of the journal once the dungeon is chosen
+ */
+void
+jnl_start(void)
+{
+    if (jnl_mode != J_ASKED)
+	return;
+    jnl_mode = J_RECORD;
+    if ((jnl_file = fopen(jnl_name, "wb")) == NULL)
+    {
+	perror(jnl_name);
+	jnl_mode = J_CLOSED;
+	return;
+    }
+    fwrite(J_MAGIC, 1, 4, jnl_file);
+    put_uint(J_VERSION);
+    put_uint(dnum);
+    put_uint(strlen(rogue_opts));
+    fwrite(rogue_opts, 1, strlen(rogue_opts), jnl_file);
+    fflush(jnl_file);
+}
+
+/*
+ * put_record:
+ *	Append the start of a record, stamped with the turn
+ */
+static void
+put_record(int code)
+{
+    put_uint(turns - jnl_turn);
+    put_uint(code);
+    jnl_turn = turns;
+}
+
+/*
+ * end_replay:
+ *	Stop taking keys from the journal, the player has them from now on
+ */
+static void
+end_replay(void)
+{
+    fclose(jnl_file);
+    jnl_file = NULL;
+    jnl_mode = J_CLOSED;
+}
+
+/*
+ * get_record:
+ *	Read the start of the next record.  Once the journal is used up
+ *	or out of step with the game the player takes over, and the
+ *	replay has failed: only a J_END with a matching hash passes
+ */
+static int
+get_record(int want, unsigned int *codep)
+{
+    unsigned int delta;
+
+    if (!get_uint(&delta) || !get_uint(codep))
+    {
+	fprintf(stderr, "%s: journal cut short after %d keys at turn %d, state %08x\n",
+	    jnl_name, jnl_keys, turns, state_hash());
+	jnl_failed = 1;
+	end_replay();
+	return FALSE;
+    }
+    jnl_turn += delta;
+    if (want == J_KEY && *codep == J_END && jnl_turn == turns)
+    {
+	jnl_mode = J_ENDED;	/* the keys ran out here too */
+	return FALSE;
+    }
+    if (jnl_turn != turns || (want == J_KEY ? *codep < J_KEY : *codep != want))
+    {
+	fprintf(stderr, "%s: out of step after %d keys at turn %d (journal turn %d)\n",
+	    jnl_name, jnl_keys, turns, jnl_turn);
+	jnl_failed = 1;
+	end_replay();
+	return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * jnl_readchar:
+ *	Read a key from the player, or from the journal when replaying.
+ *	Keys from the player are journaled.  KEY_EXIT, for input that
+ *	has run out, is not: the J_END that follows stands for it, and a
+ *	replay that reaches it runs out of keys at the same place
+ */
+int
+jnl_readchar(WINDOW *win)
+{
+    unsigned int code;
+    int ch;
+
+    if (jnl_mode == J_REPLAY && get_record(J_KEY, &code))
+    {
+	jnl_keys++;
+	return code - J_KEY;
+    }
+    if (jnl_mode == J_ENDED)
+	return KEY_EXIT;
+    ch = md_readchar(win);
+    if (jnl_mode == J_RECORD && ch != KEY_EXIT)
+    {
+	put_record(J_KEY + ch);
+	fflush(jnl_file);
+	jnl_keys++;
+    }
+    return ch;
+}
+
+/*
+ * jnl_travel:
+ *	Where the frontend wants the hero to go, from the journal when
+ *	replaying
+ */
+int
+jnl_travel(int *y, int *x)
+{
+    unsigned int code, jy, jx;
+    int found;
+
+    if (jnl_mode == J_REPLAY && get_record(J_TRAVEL, &code))
+    {
+	if (get_uint(&jy) && get_uint(&jx))
+	{
+	    *y = (int) jy - 1;
+	    *x = (int) jx - 1;
+	    return jy != 0;
+	}
+	fprintf(stderr, "%s: journal cut short after %d keys at turn %d\n",
+	    jnl_name, jnl_keys, turns);
+	jnl_failed = 1;
+	end_replay();
+    }
+    found = getTravelTarget(y, x);
+    if (jnl_mode == J_RECORD)
+    {
+	put_record(J_TRAVEL);
+	put_uint(found ? *y + 1 : 0);
+	put_uint(found ? *x + 1 : 0);
+	fflush(jnl_file);
+    }
+    return found;
+}
+
+/*
+ * jnl_close:
+ *	The game is over.  Seal the journal with a hash of the state, or
+ *	check the replay came to the same one.  Returns 1 if a replay
+ *	went wrong, ran out or ended anywhere but at its J_END
+ */
+int
+jnl_close(void)
+{
+    unsigned int delta, code, hash, h;
+
+    if (jnl_mode == J_RECORD)
+    {
+	put_record(J_END);
+	put_uint(state_hash());
+	fclose(jnl_file);
+    }
+    else if (jnl_mode == J_REPLAY || jnl_mode == J_ENDED)
+    {
+	h = state_hash();
+	if ((jnl_mode == J_REPLAY
+		&& (!get_uint(&delta) || !get_uint(&code) || code != J_END))
+	    || !get_uint(&hash))
+	{
+	    fprintf(stderr, "%s: game ended after %d keys at turn %d, state %08x\n",
+		jnl_name, jnl_keys, turns, h);
+	    jnl_failed = 1;
+	}
+	else if (hash != h)
+	{
+	    fprintf(stderr, "%s: state %08x does not match journal %08x\n",
+		jnl_name, h, hash);
+	    jnl_failed = 1;
+	}
+	else
+	    fprintf(stderr, "%s: replayed %d keys to turn %d, state %08x matches\n",
+		jnl_name, jnl_keys, turns, h);
+	fclose(jnl_file);
+    }
+    jnl_file = NULL;
+    jnl_mode = J_CLOSED;
+    return jnl_failed;
+}
@@ -11,12 +11,132 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 #include <curses.h>
 #include "rogue.h"
 
-#ifdef MASTER
-int total = 0;			/* total dynamic memory bytes */
+/*
+ * THINGs are carved out of slabs and freed ones are kept on a list
+ * threaded through l_next.  Monsters and whatever lies about on the
+ * level come from an arena of their own, which new_level() takes back
+ * in one go; anything that may outlive the level comes from the game
+ * arena.  Slabs start on a SLAB_BYTES boundary, so the slab a thing
+ * came from, and with it the arena, is found by masking its address
+ */
+#define SLAB_THINGS	64
+#define SLAB_BYTES	8192	/* a power of two a slab fits in */
+
+typedef struct arena ARENA;
+
+typedef struct slab {
+    struct slab *s_next;
+    ARENA *s_arena;		/* the arena the slab belongs to */
+    THING s_things[SLAB_THINGS];
+} SLAB;
+
+typedef char slab_fits[sizeof (SLAB) <= SLAB_BYTES ? 1 : -1];
+
+#define slab_of(item)	((SLAB *) ((uintptr_t) (item) & ~(uintptr_t) (SLAB_BYTES - 1)))
+
+struct arena {
+    SLAB *a_slabs;		/* every slab, oldest first */
+    SLAB *a_cur;		/* slab being handed out */
+    int a_used;			/* things handed out of a_cur */
+    THING *a_free;		/* things given back */
+};
+
+static TLOCAL ARENA game_arena;
+static TLOCAL ARENA lvl_arena;
+
+TLOCAL int  things_live = 0;		/* THINGs in use */
+TLOCAL int  things_peak = 0;		/* Most THINGs ever in use at once */
+TLOCAL int  lvl_things_live = 0;	/* Of those, how many the level has */
+TLOCAL int  lvl_things_peak = 0;	/* Most the level arena ever had */
+
+/*
+ * slab_alloc:
+ *	Get a slab from the C library, on a SLAB_BYTES boundary
+ */
+static SLAB *
+slab_alloc(void)
+{
+    void *mem;
+
+#ifdef _WIN32
+    mem = _aligned_malloc(SLAB_BYTES, SLAB_BYTES);
+#else
+    if (posix_memalign(&mem, SLAB_BYTES, SLAB_BYTES) != 0)
+	mem = NULL;
+#endif
+    return mem;
+}
+
+/*
+ * slab_free:
+ *	Hand a slab back
+ */
+static void
+slab_free(SLAB *sp)
+{
+#ifdef _WIN32
+    _aligned_free(sp);
+#else
+    free(sp);
 #endif
+}
+
+/*
+ * arena_alloc:
+ *	Hand out a thing from the free list or the next unused spot,
+ *	getting another slab when they have all gone
+ */
+static THING *
+arena_alloc(ARENA *ap)
+{
+    THING *item;
+    SLAB *sp;
+
+    if ((item = ap->a_free) != NULL)
+    {
+	ap->a_free = next(item);
+	return item;
+    }
+    if (ap->a_cur == NULL || ap->a_used == SLAB_THINGS)
+    {
+	if (ap->a_cur != NULL && ap->a_cur->s_next != NULL)
+	    sp = ap->a_cur->s_next;
+	else if (ap->a_cur == NULL && ap->a_slabs != NULL)
+	    sp = ap->a_slabs;
+	else
+	{
+	    if ((sp = slab_alloc()) == NULL)
+		return NULL;
+	    sp->s_next = NULL;
+	    sp->s_arena = ap;
+	    if (ap->a_cur != NULL)
+		ap->a_cur->s_next = sp;
+	    else
+		ap->a_slabs = sp;
+	}
+	ap->a_cur = sp;
+	ap->a_used = 0;
+    }
+    return &ap->a_cur->s_things[ap->a_used++];
+}
+
+/*
+ * lvl_owned:
+ *	Did this thing come from the level arena
+ */
+static int
+lvl_owned(const THING *item)
+{
+    return slab_of(item)->s_arena == &lvl_arena;
+}
 
 /*
  * detach:
@@ -34,6 +154,12 @@ _detach(THING **list, THING *item)
 	item->l_next->l_prev = prev(item);
     item->l_next = NULL;
     item->l_prev = NULL;
+    if (list == &lvl_obj)
+    {
+	if (objat(item->o_pos.y, item->o_pos.x) == item)
+	    objat(item->o_pos.y, item->o_pos.x) = NULL;
+	show_obj(item, FALSE);
+    }
 }
 
 /*
@@ -56,8 +182,63 @@ _attach(THING **list, THING *item)
 	item->l_prev = NULL;
     }
     *list = item;
+    if (list == &lvl_obj)
+    {
+	objat(item->o_pos.y, item->o_pos.x) = item;
+	show_obj(item, TRUE);
+    }
 }
 
+/*
+ * index_objs:
+ *	Point every spot at the object lying on it, after lvl_obj has
+ *	been put together without attach()
+ */
+void
+index_objs(void)
+{
+    THING *obj;
+#ifdef PLACES_SOA
+
+    memset(place_obj, 0, sizeof place_obj);
+#else
+    PLACE *pp;
+
+    for (pp = places; pp < &places[MAXCOLS*MAXLINES]; pp++)
+	pp->p_obj = NULL;
+#endif /* PLACES_SOA */
+    for (obj = lvl_obj; obj != NULL; obj = next(obj))
+	objat(obj->o_pos.y, obj->o_pos.x) = obj;
+}
+
+# ifdef DEBUG
+/*
+ * check_objs:
+ *	Make sure the spots and lvl_obj agree about where everything is
+ */
+void
+check_objs(void)
+{
+    THING *obj;
+    int n, y, x;
+
+    n = 0;
+    for (obj = lvl_obj; obj != NULL; obj = next(obj))
+    {
+	if (objat(obj->o_pos.y, obj->o_pos.x) != obj)
+	    msg("object index lost %s at (%d,%d)", inv_name(obj, FALSE),
+		unc(obj->o_pos));
+	n++;
+    }
+    for (y = 0; y < MAXLINES; y++)
+	for (x = 0; x < MAXCOLS; x++)
+	    if (objat(y, x) != NULL)
+		n--;
+    if (n != 0)
+	msg("object index holds %d stale objects", -n);
+}
+# endif /* DEBUG */
+
 /*
  * _free_list:
  *	Throw the whole blamed thing away
@@ -76,6 +257,27 @@ _free_list(THING **ptr)
     }
 }
 
+/*
+ * _drop_list:
+ *	Let go of a list the level is done with.  What came from the
+ *	level arena goes back with clear_lvl_items(), only the rest is
+ *	freed here
+ */
+
+void
+_drop_list(THING **ptr)
+{
+    THING *item;
+
+    while (*ptr != NULL)
+    {
+	item = *ptr;
+	*ptr = next(item);
+	if (!lvl_owned(item))
+	    discard(item);
+    }
+}
+
 /*
  * discard:
  *	Free up an item
@@ -84,33 +286,132 @@ _free_list(THING **ptr)
 void
 discard(THING *item)
 {
+    ARENA *ap;
+
+    if (lvl_owned(item))
+    {
+	ap = &lvl_arena;
+	lvl_things_live--;
+    }
+    else
+	ap = &game_arena;
+    things_live--;
+    item->l_next = ap->a_free;
+    ap->a_free = item;
+}
+
+/*
+ * alloc_item:
+ *	Get a cleared thing out of an arena and count it
+ */
+static THING *
+alloc_item(ARENA *ap)
+{
+    THING *item;
+
+    if ((item = arena_alloc(ap)) == NULL)
+    {
 #ifdef MASTER
-    total--;
+	msg("ran out of memory after %d items", things_live);
 #endif
-    free(item);
+	return NULL;
+    }
+    memset(item, 0, sizeof *item);
+    if (++things_live > things_peak)
+	things_peak = things_live;
+    return item;
 }
 
 /*
  * new_item
- *	Get a new item with a specified size
+ *	Get a new item that may be kept for the whole game
  */
 THING *
 new_item(void)
+{
+    return alloc_item(&game_arena);
+}
+
+/*
+ * new_lvl_item:
+ *	Get a new item that goes away with the level
+ */
+THING *
+new_lvl_item(void)
 {
     THING *item;
 
-	if ((item = calloc(1, sizeof *item)) == NULL) {
-#ifdef MASTER
-		msg("ran out of memory after %d items", total);
-#endif
-		return NULL;
-	}
+    if ((item = alloc_item(&lvl_arena)) != NULL
+	&& ++lvl_things_live > lvl_things_peak)
+	    lvl_things_peak = lvl_things_live;
+    return item;
+}
 
-#ifdef MASTER
-	total++;
-#endif
+/*
+ * keep_item:
+ *	Move a thing out of the level arena so it can leave the level,
+ *	putting the copy in its place in the list
+ */
+THING *
+_keep_item(THING **list, THING *item)
+{
+    THING *nitem;
 
-	item->l_next = NULL;
-    item->l_prev = NULL;
-    return item;
+    if (!lvl_owned(item) || (nitem = new_item()) == NULL)
+	return item;
+    *nitem = *item;
+    if (*list == item)
+	*list = nitem;
+    if (prev(item) != NULL)
+	next(prev(item)) = nitem;
+    if (next(item) != NULL)
+	prev(next(item)) = nitem;
+    discard(item);
+    return nitem;
+}
+
+/*
+ * clear_lvl_items:
+ *	Take back everything the level arena has handed out.  Anything
+ *	still pointing into it has to be gone by now
+ */
+void
+clear_lvl_items(void)
+{
+    lvl_arena.a_cur = NULL;
+    lvl_arena.a_used = 0;
+    lvl_arena.a_free = NULL;
+    things_live -= lvl_things_live;
+    lvl_things_live = 0;
+}
+
+/*
+ * free_arena:
+ *	Hand every slab of an arena back to the C library
+ */
+static void
+free_arena(ARENA *ap)
+{
+    SLAB *sp;
+
+    while ((sp = ap->a_slabs) != NULL)
+    {
+	ap->a_slabs = sp->s_next;
+	slab_free(sp);
+    }
+    memset(ap, 0, sizeof *ap);
+}
+
+/*
+ * free_things:
+ *	Let go of every thing when the game is over, so a thread that
+ *	played one leaves nothing behind
+ */
+void
+free_things(void)
+{
+    free_arena(&game_arena);
+    free_arena(&lvl_arena);
+    things_live = 0;
+    lvl_things_live = 0;
 }
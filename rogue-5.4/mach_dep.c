@@ -57,7 +57,7 @@
 # endif
 
 #ifdef CHECKTIME
-static int num_checks = 0;		/* times we've gone over in checkout() */
+static TLOCAL int num_checks = 0;		/* times we've gone over in checkout() */
 #endif /* CHECKTIME */
 
 /*
@@ -366,7 +366,7 @@ ucount(void)
  *	lock the score file.  If it takes too long, ask the user if
  *	they care to wait.  Return TRUE if the lock is successful.
  */
-static FILE *lfd = NULL;
+static TLOCAL FILE *lfd = NULL;
 int
 lock_sc(void)
 {
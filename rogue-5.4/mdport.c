@@ -284,7 +284,7 @@ md_putchar(int c)
 }
 
 #ifdef _WIN32
-static int md_standout_mode = 0;
+static TLOCAL int md_standout_mode = 0;
 #endif
 
 void
@@ -421,10 +421,27 @@ md_getpid(void)
 #endif
 }
 
+#if !defined(_WIN32) && !defined(__DJGPP__) && !defined(DJGPP)
+/*
+ * md_getpwuid:
+ *	getpwuid() into the caller's buffers, its static result is
+ *	shared by every game thread
+ */
+static struct passwd *
+md_getpwuid(uid_t uid, struct passwd *pwd, char *buf, size_t len)
+{
+    struct passwd *pw = NULL;
+
+    if (getpwuid_r(uid, pwd, buf, len, &pw) != 0)
+	return NULL;
+    return pw;
+}
+#endif
+
 char *
 md_getusername(void)
 {
-    static char login[80];
+    static TLOCAL char login[80];
     char *l = NULL;
 
     /* POSIX Shell has priority, then O/S specific methods */
@@ -444,7 +461,8 @@ md_getusername(void)
     GetUserName(mybuffer,&size);
     l = mybuffer;
 #elif defined(HAVE_GETPWUID)&& !defined(__DJGPP__)
-    struct passwd *pw;
+    struct passwd pwd, *pw;
+    char pwbuf[1024];
 
 #if CC_PLATFORM_IOS
     if (1) {
@@ -453,9 +471,8 @@ md_getusername(void)
     }
 #endif
     
-    pw = getpwuid(getuid());
-
-    l = pw->pw_name;
+    if ((pw = md_getpwuid(getuid(), &pwd, pwbuf, sizeof(pwbuf))) != NULL)
+        l = pw->pw_name;
 #endif
 
     if ((l == NULL) || (*l == '\0'))
@@ -473,7 +490,7 @@ md_getusername(void)
 char *
 md_gethomedir(void)
 {
-    static char homedir[PATH_MAX];
+    static TLOCAL char homedir[PATH_MAX];
     char *h = NULL;
     size_t len;
 #if defined(_WIN32)
@@ -485,18 +502,22 @@ md_gethomedir(void)
     char slash = '/';
     
 #if CC_PLATFORM_IOS
-    if (1) {
-        strcpy(homedir, "/");
+    /*
+     * the sandbox root is not writable, the app's Documents are
+     */
+    if ((h = getenv("HOME")) != NULL && strlen(h) < PATH_MAX - 12) {
+        sprintf(homedir, "%s/Documents/", h);
         return homedir;
     }
 #endif
     
-    struct passwd *pw;
-    pw = getpwuid(getuid());
+    struct passwd pwd, *pw;
+    char pwbuf[1024];
 
-    h = pw->pw_dir;
+    if ((pw = md_getpwuid(getuid(), &pwd, pwbuf, sizeof(pwbuf))) != NULL)
+        h = pw->pw_dir;
     
-    if (strcmp(h,"/") == 0)
+    if (h != NULL && strcmp(h,"/") == 0)
         h = NULL;
 #endif
     homedir[0] = 0;
@@ -548,7 +569,7 @@ md_sleep(int s)
 char *
 md_getshell(void)
 {
-    static char shell[PATH_MAX];
+    static TLOCAL char shell[PATH_MAX];
     char *s = NULL;
 #ifdef _WIN32
     char *def = "C:\\WINDOWS\\SYSTEM32\\CMD.EXE";
@@ -556,9 +577,11 @@ md_getshell(void)
     char *def = "C:\\COMMAND.COM";
 #else
     char *def = "/bin/sh";
-    struct passwd *pw;
-    pw = getpwuid(getuid());
-    s = pw->pw_shell;
+    struct passwd pwd, *pw;
+    char pwbuf[1024];
+
+    if ((pw = md_getpwuid(getuid(), &pwd, pwbuf, sizeof(pwbuf))) != NULL)
+        s = pw->pw_shell;
 #endif
     if ((s == NULL) || (*s == '\0'))
         if ( (s = getenv("COMSPEC")) == NULL)
@@ -635,17 +658,23 @@ directory_exists(char *dirname)
 char *
 md_getrealname(uid_t uid)
 {
-    static char uidstr[20];
+    static TLOCAL char uidstr[20];
 #if !defined(_WIN32) && !defined(DJGPP)
-    struct passwd *pp;
+    static TLOCAL char name[80];
+    struct passwd pwd, *pp;
+    char pwbuf[1024];
 
-	if ((pp = getpwuid(uid)) == NULL)
+	if ((pp = md_getpwuid(uid, &pwd, pwbuf, sizeof(pwbuf))) == NULL)
     {
         sprintf(uidstr,"%d", uid);
         return(uidstr);
     }
 	else
-	    return(pp->pw_name);
+    {
+	    strncpy(name, pp->pw_name, sizeof(name) - 1);
+	    name[sizeof(name) - 1] = 0;
+	    return(name);
+    }
 #else
    sprintf(uidstr,"%ld", uid);
    return(uidstr);
@@ -665,7 +694,7 @@ md_getpass(char *prompt)
     return "";
 #else
 #ifndef HAVE_GETPASS
-    static char password_buffer[9];
+    static TLOCAL char password_buffer[9];
     char *p = password_buffer;
     int c, count = 0;
     int max_length = 9;
@@ -1107,8 +1136,8 @@ md_setsuspchar(int c)
 #define M_KEYPAD 2
 #define M_TRAIL  3
 
-int undo[5];
-int uindex = -1;
+TLOCAL int undo[5];
+TLOCAL int uindex = -1;
 
 int
 reread()
@@ -1174,6 +1203,9 @@ md_readchar(WINDOW *win)
 
         count = 0;                      /* reset input error count     */
 
+        if (ch == KEY_EXIT)             /* input is gone for good      */
+            break;
+
 	if (mode == M_TRAIL)
 	{
 	    if (ch == '^')		/* msys console  : 7,5,6,8: modified*/
@@ -1406,6 +1438,9 @@ md_readchar(WINDOW *win)
 
     uindex = -1;
 
+    if (ch == KEY_EXIT)
+	return(ch);
+
     return(ch & 0x7F);
 }
 
@@ -29,14 +29,15 @@ look(int wakeup)
     int x, y;
     chtype ch;
     THING *tp;
-    PLACE *pp;
+    MAPSPOT pp;
     struct room *rp;
     int ey, ex;
     int passcount;
-    int pfl, *fp, pch;
+    int pfl, pch;
+    pflag_t *fp;
     int sy, sx, sumhero = 0, diffhero = 0;
 # ifdef DEBUG
-    static int done = FALSE;
+    static TLOCAL int done = FALSE;
 
     if (done)
 	return;
@@ -60,8 +61,8 @@ look(int wakeup)
 	diffhero = hero.y - hero.x;
     }
     pp = INDEX(hero.y, hero.x);
-    pch = pp->p_ch;
-    pfl = pp->p_flags;
+    pch = spot_ch(pp);
+    pfl = spot_flags(pp);
 
     for (y = sy; y <= ey; y++)
 	if (y > 0 && y < NUMLINES - 1) for (x = sx; x <= ex; x++)
@@ -75,10 +76,10 @@ look(int wakeup)
 	    }
 
 	    pp = INDEX(y, x);
-	    ch = pp->p_ch;
+	    ch = spot_ch(pp);
 	    if (ch == ' ')		/* nothing need be done with a ' ' */
 		    continue;
-	    fp = &pp->p_flags;
+	    fp = &spot_flags(pp);
 	    if (pch != DOOR && ch != DOOR)
 		if ((pfl & F_PASS) != (*fp & F_PASS))
 		    continue;
@@ -90,7 +91,7 @@ look(int wakeup)
 			continue;
 	    }
 
-	    if ((tp = pp->p_monst) == NULL)
+	    if ((tp = spot_monst(pp)) == NULL)
 		ch = trip_ch(y, x, ch);
 	    else
 		if (on(player, SEEMONST) && on(*tp, ISINVIS))
@@ -151,10 +152,14 @@ look(int wakeup)
 			if ((y - x) - diffhero <= -1)
 			    continue;
 		}
+		/*
+		 * travelling already knows its way past doors and
+		 * forks, and should not stop short of what it is after
+		 */
 		switch (ch)
 		{
 		    case DOOR:
-			if (x == hero.x || y == hero.y)
+			if (!travelling && (x == hero.x || y == hero.y))
 			    running = FALSE;
 			break;
 		    case PASSAGE:
@@ -167,12 +172,14 @@ look(int wakeup)
 		    case ' ':
 			break;
 		    default:
-			running = FALSE;
+			if (!travelling || tp != NULL
+			    || y != travel_dest.y || x != travel_dest.x)
+				running = FALSE;
 			break;
 		}
 	    }
 	}
-    if (door_stop && !firstmove && passcount > 1)
+    if (door_stop && !firstmove && passcount > 1 && !travelling)
 	running = FALSE;
     if (!running || !jump)
 	mvaddch(hero.y, hero.x, PLAYER);
@@ -258,11 +265,8 @@ find_obj(int y, int x)
 {
     THING *obj;
 
-    for (obj = lvl_obj; obj != NULL; obj = next(obj))
-    {
-	if (obj->o_pos.y == y && obj->o_pos.x == x)
-		return obj;
-    }
+    if ((obj = objat(y, x)) != NULL)
+	return obj;
 #ifdef MASTER
     sprintf(prbuf, "Non-object %d,%d", y, x);
     msg(prbuf);
@@ -464,7 +468,7 @@ get_dir(void)
 {
     char *prompt;
     int gotit;
-    static coord last_delt= {0,0};
+    static TLOCAL coord last_delt= {0,0};
 
     if (again && last_dir != '\0')
     {
@@ -557,6 +561,7 @@ call_it(struct obj_info *info)
     else if (!info->oi_guess)
     {
 	msg(terse ? "call it: " : "what do you want to call it? ");
+	show_prompt(PR_NAME);
 	if (get_str(prbuf, stdscr) == NORM)
 	{
 	    if (info->oi_guess != NULL)
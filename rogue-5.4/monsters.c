@@ -122,7 +122,7 @@ wanderer(void)
     coord cp;
     int cnt = 0;
 
-    tp = new_item();
+    tp = new_lvl_item();
     do
     {
         /* Avoid endless loop when all rooms are filled with monsters
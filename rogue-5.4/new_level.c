@@ -22,38 +22,53 @@
 void
 new_level(void)
 {
-    THING *tp;
-    PLACE *pp;
-    int *sp;
-    int i;
-
     player.t_flags &= ~ISHELD;	/* unhold when you go down just in case */
     if (level > max_level)
 	max_level = level;
     /*
      * Clean things off from last level
      */
-    for (pp = places; pp < &places[MAXCOLS*MAXLINES]; pp++)
-    {
-	pp->p_ch = ' ';
-	pp->p_flags = F_REAL;
-	pp->p_monst = NULL;
-    }
+    clear_places();
     clear();
-    /*
-     * Free up the monsters on the last level
-     */
-    for (tp = mlist; tp != NULL; tp = next(tp))
-	free_list(tp->t_pack);
-    free_list(mlist);
-    /*
-     * Throw away stuff left on the previous level (if anything)
-     */
-    free_list(lvl_obj);
+    drop_level();
+    dig_level();
+    show_lvl_objs();			/* Tell the frontend where they are */
+    seenstairs = FALSE;
+
+    enter_room(&hero);
+    mvaddch(hero.y, hero.x, PLAYER);
+    if (on(player, SEEMONST))
+	turn_see(FALSE);
+    if (on(player, ISHALU))
+	visuals();
+}
+
+/*
+ * dig_level:
+ *	Dig out the rooms and passages, put down things, traps and the
+ *	stairs and find a spot for the hero, all on a cleared map
+ */
+void
+dig_level(void)
+{
     do_rooms();				/* Draw rooms */
     do_passages();			/* Draw passages */
     no_food++;
     put_things();			/* Place objects (if any) */
+    put_stairs();			/* Traps, stairs and the hero */
+}
+
+/*
+ * put_stairs:
+ *	Place the traps and the staircase down, and find the hero a spot
+ */
+void
+put_stairs(void)
+{
+    THING *tp;
+    pflag_t *sp;
+    int i;
+
     /*
      * Place the traps
      */
@@ -86,18 +101,56 @@ new_level(void)
      */
     find_floor(NULL, &stairs, FALSE, FALSE);
     chat(stairs.y, stairs.x) = STAIRS;
-    seenstairs = FALSE;
 
     for (tp = mlist; tp != NULL; tp = next(tp))
 	tp->t_room = roomin(&tp->t_pos);
 
     find_floor(NULL, &hero, FALSE, TRUE);
-    enter_room(&hero);
-    mvaddch(hero.y, hero.x, PLAYER);
-    if (on(player, SEEMONST))
-	turn_see(FALSE);
-    if (on(player, ISHALU))
-	visuals();
+}
+
+/*
+ * drop_level:
+ *	Free up the monsters and the things left on the last level
+ */
+void
+drop_level(void)
+{
+    THING *tp;
+
+    for (tp = mlist; tp != NULL; tp = next(tp))
+	drop_list(tp->t_pack);
+    drop_list(mlist);
+    drop_list(lvl_obj);
+    clear_lvl_items();
+}
+
+/*
+ * clear_places:
+ *	Wipe the level map.  Kept as separate arrays, each one is
+ *	filled in a single pass
+ */
+void
+clear_places(void)
+{
+#ifdef PLACES_SOA
+    int i;
+
+    memset(place_ch, ' ', sizeof place_ch);
+    for (i = 0; i < MAXLINES*MAXCOLS; i++)
+	place_flags[i] = F_REAL;
+    memset(place_monst, 0, sizeof place_monst);
+    memset(place_obj, 0, sizeof place_obj);
+#else
+    PLACE *pp;
+
+    for (pp = places; pp < &places[MAXCOLS*MAXLINES]; pp++)
+    {
+	pp->p_ch = ' ';
+	pp->p_flags = F_REAL;
+	pp->p_monst = NULL;
+	pp->p_obj = NULL;
+    }
+#endif
 }
 
 /*
@@ -148,12 +201,12 @@ put_things(void)
 	     * Pick a new object and link it in the list
 	     */
 	    obj = new_thing();
-	    attach(lvl_obj, obj);
 	    /*
 	     * Put it somewhere
 	     */
 	    find_floor(NULL, &obj->o_pos, FALSE, FALSE);
 	    chat(obj->o_pos.y, obj->o_pos.x) = obj->o_type;
+	    attach(lvl_obj, obj);
 	}
     /*
      * If he is really deep in the dungeon and he hasn't found the
@@ -161,8 +214,7 @@ put_things(void)
      */
     if (level >= AMULETLEVEL && !amulet)
     {
-	obj = new_item();
-	attach(lvl_obj, obj);
+	obj = new_lvl_item();
 	obj->o_hplus = 0;
 	obj->o_dplus = 0;
 	strncpy(obj->o_damage,"0x0",sizeof(obj->o_damage));
@@ -174,6 +226,7 @@ put_things(void)
 	 */
 	find_floor(NULL, &obj->o_pos, FALSE, FALSE);
 	chat(obj->o_pos.y, obj->o_pos.x) = AMULET;
+	attach(lvl_obj, obj);
     }
 }
 
@@ -222,7 +275,7 @@ treas_room(void)
 	spots = 0;
 	if (find_floor(rp, &mp, MAXTRIES, TRUE))
 	{
-	    tp = new_item();
+	    tp = new_lvl_item();
 	    new_monster(tp, randmonster(FALSE), &mp);
 	    tp->t_flags |= ISMEAN;	/* no sloughers in THIS room */
 	    give_pack(tp);
@@ -20,7 +20,7 @@
 
 #define	EQSTR(a, b, c)	(strncmp(a, b, c) == 0)
 
-#define	NUM_OPTS	(sizeof optlist / sizeof (OPTION))
+#define	NUM_OPTS	13
 
 /*
  * description of an option and what to do with it
@@ -39,28 +39,47 @@ typedef struct optstruct	OPTION;
 
 void	pr_optname(const OPTION *op);
 
-static const OPTION	optlist[] = {
-    {"terse",	 "Terse output",
+/*
+ * The options point at the game's globals, which have no fixed address
+ * when every thread has its own, so the table is put together when it
+ * is needed
+ */
+static TLOCAL OPTION	optlist[NUM_OPTS];
+
+static void
+set_optlist(void)
+{
+    const OPTION opts[NUM_OPTS] = {
+	{"terse",	 "Terse output",
 		 &terse,	put_bool,	get_bool	},
-    {"flush",	 "Flush typeahead during battle",
+	{"flush",	 "Flush typeahead during battle",
 		 &fight_flush,	put_bool,	get_bool	},
-    {"jump",	 "Show position only at end of run",
+	{"jump",	 "Show position only at end of run",
 		 &jump,		put_bool,	get_bool	},
-    {"seefloor", "Show the lamp-illuminated floor",
+	{"seefloor", "Show the lamp-illuminated floor",
 		 &see_floor,	put_bool,	get_sf		},
-    {"passgo",	"Follow turnings in passageways",
+	{"passgo",	"Follow turnings in passageways",
 		 &passgo,	put_bool,	get_bool	},
-    {"tombstone", "Print out tombstone when killed",
+	{"flowchase", "Monsters find their way round walls",
+		 &flow_chase,	put_bool,	get_bool	},
+	{"travel",	"Steps between redraws when travelling (0: at end only)",
+		 &travel_draw,	put_num,	get_num		},
+	{"autosave",	"Turns between autosaves (0: never)",
+		 &autosave_turns, put_num,	get_num		},
+	{"tombstone", "Print out tombstone when killed",
 		 &tombstone,	put_bool,	get_bool	},
-    {"inven",	"Inventory style",
+	{"inven",	"Inventory style",
 		 &inv_type,	put_inv_t,	get_inv_t	},
-    {"name",	 "Name",
+	{"name",	 "Name",
 		 whoami,	put_str,	get_str		},
-    {"fruit",	 "Fruit",
+	{"fruit",	 "Fruit",
 		 fruit,		put_str,	get_str		},
-    {"file",	 "Save file",
+	{"file",	 "Save file",
 		 file_name,	put_str,	get_str		}
-};
+    };
+
+    memcpy(optlist, opts, sizeof optlist);
+}
 
 /*
  * option:
@@ -73,7 +92,9 @@ option(void)
     const OPTION *op;
     int		retval;
 
+    set_optlist();
     wclear(hw);
+    show_menu(TRUE);
     /*
      * Display current values of options
      */
@@ -114,6 +135,7 @@ option(void)
     waddstr(hw, "--Press space to continue--");
     wrefresh(hw);
     wait_for(hw, ' ');
+    show_menu(FALSE);
     clearok(curscr, TRUE);
     touchwin(stdscr);
     after = FALSE;
@@ -152,6 +174,17 @@ put_str(void *str)
     waddstr(hw, (char *) str);
 }
 
+/*
+ * put_num:
+ *	Put out a number
+ */
+
+void
+put_num(void *ip)
+{
+    wprintw(hw, "%d", *(int *) ip);
+}
+
 /*
  * put_inv_t:
  *	Put out an inventory type
@@ -254,7 +287,7 @@ get_str(void *vopt, WINDOW *win)
     int oy, ox;
     size_t i;
     int c;
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
     getyx(win, oy, ox);
     wrefresh(win);
@@ -370,7 +403,6 @@ get_inv_t(void *vp, WINDOW *win)
 }
 	
 
-#ifdef MASTER
 /*
  * get_num:
  *	Get a numeric option
@@ -380,13 +412,13 @@ get_num(void *vp, WINDOW *win)
 {
     int *opt = (int *) vp;
     int i;
-    static char buf[MAXSTR];
+    static TLOCAL char buf[MAXSTR];
 
+    sprintf(buf, "%d", *opt);
     if ((i = get_str(buf, win)) == NORM)
 	*opt = atoi(buf);
     return i;
 }
-#endif
 
 /*
  * parse_opts:
@@ -406,6 +438,7 @@ parse_opts(char *str)
     const char **i;
     char *start;
 
+    set_optlist();
     while (*str)
     {
 	/*
@@ -422,6 +455,14 @@ parse_opts(char *str)
 	    {
 		if (op->o_putfunc == put_bool)	/* if option is a boolean */
 		    *(int *)op->o_opt = TRUE;	/* NOSTRICT */
+		else if (op->o_putfunc == put_num)	/* numeric option */
+		{
+		    for (str = sp + 1; *str == '='; str++)
+			continue;
+		    *(int *)op->o_opt = atoi(str);	/* NOSTRICT */
+		    for (sp = str; *sp && *sp != ','; sp++)
+			continue;
+		}
 		else				/* string option */
 		{
 		    /*
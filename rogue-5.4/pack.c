@@ -15,6 +15,9 @@
 #include <ctype.h>
 #include "rogue.h"
 
+static TLOCAL int picking = FALSE;		/* get_item is waiting for a letter */
+static TLOCAL int pick_type;			/* and the type it is asking for */
+
 /*
  * update_mdest:
  *      Called after picking up an object, before discarding it.
@@ -163,6 +166,7 @@ out:
      */
     if (!discarded)
         update_mdest(obj);
+    obj = keep_item(pack, obj);
 
     if (obj->o_type == AMULET)
 	amulet = TRUE;
@@ -267,14 +271,12 @@ pack_char(void)
 int
 inventory(const THING *list, int type)
 {
-    static char inv_temp[MAXSTR];
+    static TLOCAL char inv_temp[MAXSTR];
 
     n_objs = 0;
     for (; list != NULL; list = next(list))
     {
-	if (type && type != list->o_type && !(type == CALLABLE &&
-	    list->o_type != FOOD && list->o_type != AMULET) &&
-	    !(type == R_OR_S && (list->o_type == RING || list->o_type == STICK)))
+	if (!type_fits(list, type))
 		continue;
 	n_objs++;
 #ifdef MASTER
@@ -306,6 +308,43 @@ inventory(const THING *list, int type)
     return TRUE;
 }
 
+/*
+ * type_fits:
+ *	Is this object of the type asked for, allowing for the
+ *	CALLABLE and R_OR_S classes
+ */
+int
+type_fits(const THING *obj, int type)
+{
+    if (type == 0 || type == obj->o_type)
+	return TRUE;
+    if (type == CALLABLE)
+	return obj->o_type != FOOD && obj->o_type != AMULET;
+    if (type == R_OR_S)
+	return obj->o_type == RING || obj->o_type == STICK;
+    return FALSE;
+}
+
+/*
+ * is_picking:
+ *	Is get_item waiting for the player to choose something
+ */
+int
+is_picking(void)
+{
+    return picking;
+}
+
+/*
+ * pick_fits:
+ *	Would the item get_item is waiting for take this object
+ */
+int
+pick_fits(const THING *obj)
+{
+    return picking && type_fits(obj, pick_type);
+}
+
 /*
  * pick_up:
  *	Add something to characters pack.
@@ -425,7 +464,11 @@ get_item(const char *purpose, int type)
 	    if (terse)
 		addmsg(" what");
 	    msg("? (* for list): ");
+	    show_prompt(PR_ITEM);
+	    picking = TRUE;
+	    pick_type = type;
 	    ch = readchar();
+	    picking = FALSE;
 	    mpos = 0;
 	    /*
 	     * Give the poor player a chance to abort the command
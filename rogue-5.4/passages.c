@@ -124,6 +124,27 @@ do_passages(void)
     passnum();
 }
 
+/*
+ * maze_exit:
+ *	A maze in the top row of rooms does not always come out along
+ *	its bottom edge.  If the side a tunnel is to leave a maze by has
+ *	no way out, open one beside the maze's corner, or conn() would
+ *	look for one forever
+ */
+static void
+maze_exit(int y, int x, int dy, int dx, int len)
+{
+    coord cp;
+    int i;
+
+    for (i = 0; i < len; i++)
+	if (flat(y + i * dy, x + i * dx) & F_PASS)
+	    return;
+    cp.y = y + dy;
+    cp.x = x + dx;
+    putpass(&cp);
+}
+
 /*
  * conn:
  *	Draw a corridor from a room in a certain direction.
@@ -137,7 +158,7 @@ conn(int r1, int r2)
     int distance = 0, turn_spot, turn_distance = 0;
     int rm;
     int direc;
-    static coord del, turn_delta;
+    static TLOCAL coord del, turn_delta;
     coord curr, spos, epos;
 
     if (r1 < r2)
@@ -171,6 +192,11 @@ conn(int r1, int r2)
 	spos.y = rpf->r_pos.y;
 	epos.x = rpt->r_pos.x;			/* end of move */
 	epos.y = rpt->r_pos.y;
+	if (rpf->r_flags & ISMAZE)
+	    maze_exit(rpf->r_pos.y + rpf->r_max.y - 1, rpf->r_pos.x + 1,
+		0, 1, rpf->r_max.x - 2);
+	if (rpt->r_flags & ISMAZE)
+	    maze_exit(rpt->r_pos.y, rpt->r_pos.x + 1, 0, 1, rpt->r_max.x - 2);
 	if (!(rpf->r_flags & ISGONE))		/* if not gone pick door pos */
 	    do
 	    {
@@ -197,6 +223,11 @@ conn(int r1, int r2)
 	spos.y = rpf->r_pos.y;
 	epos.x = rpt->r_pos.x;
 	epos.y = rpt->r_pos.y;
+	if (rpf->r_flags & ISMAZE)
+	    maze_exit(rpf->r_pos.y + 1, rpf->r_pos.x + rpf->r_max.x - 1,
+		1, 0, rpf->r_max.y - 2);
+	if (rpt->r_flags & ISMAZE)
+	    maze_exit(rpt->r_pos.y + 1, rpt->r_pos.x, 1, 0, rpt->r_max.y - 2);
 	if (!(rpf->r_flags & ISGONE))
 	    do
 	    {
@@ -274,14 +305,14 @@ conn(int r1, int r2)
 void
 putpass(const coord *cp)
 {
-    PLACE *pp;
+    MAPSPOT pp;
 
     pp = INDEX(cp->y, cp->x);
-    pp->p_flags |= F_PASS;
+    spot_flags(pp) |= F_PASS;
     if (rnd(10) + 1 < level && rnd(40) == 0)
-	pp->p_flags &= ~F_REAL;
+	spot_flags(pp) &= ~F_REAL;
     else
-	pp->p_ch = PASSAGE;
+	spot_ch(pp) = PASSAGE;
 }
 
 /*
@@ -293,7 +324,7 @@ putpass(const coord *cp)
 void
 door(struct room *rm, const coord *cp)
 {
-    PLACE *pp;
+    MAPSPOT pp;
 
     rm->r_exit[rm->r_nexits++] = *cp;
 
@@ -304,13 +335,13 @@ door(struct room *rm, const coord *cp)
     if (rnd(10) + 1 < level && rnd(5) == 0)
     {
 	if (cp->y == rm->r_pos.y || cp->y == rm->r_pos.y + rm->r_max.y - 1)
-		pp->p_ch = '-';
+		spot_ch(pp) = '-';
 	else
-		pp->p_ch = '|';
-	pp->p_flags &= ~F_REAL;
+		spot_ch(pp) = '|';
+	spot_flags(pp) &= ~F_REAL;
     }
     else
-	pp->p_ch = DOOR;
+	spot_ch(pp) = DOOR;
 }
 
 #ifdef MASTER
@@ -322,7 +353,7 @@ door(struct room *rm, const coord *cp)
 void
 add_pass(void)
 {
-    PLACE *pp;
+    MAPSPOT pp;
     int y, x;
     int ch;
 
@@ -330,22 +361,22 @@ add_pass(void)
 	for (x = 0; x < NUMCOLS; x++)
 	{
 	    pp = INDEX(y, x);
-	    if ((pp->p_flags & F_PASS) || pp->p_ch == DOOR ||
-		(!(pp->p_flags&F_REAL) && (pp->p_ch == '|' || pp->p_ch == '-')))
+	    if ((spot_flags(pp) & F_PASS) || spot_ch(pp) == DOOR ||
+		(!(spot_flags(pp)&F_REAL) && (spot_ch(pp) == '|' || spot_ch(pp) == '-')))
 	    {
-		ch = pp->p_ch;
-		if (pp->p_flags & F_PASS)
+		ch = spot_ch(pp);
+		if (spot_flags(pp) & F_PASS)
 		    ch = PASSAGE;
-		pp->p_flags |= F_SEEN;
+		spot_flags(pp) |= F_SEEN;
 		move(y, x);
-		if (pp->p_monst != NULL)
-		    pp->p_monst->t_oldch = pp->p_ch;
-		else if (pp->p_flags & F_REAL)
+		if (spot_monst(pp) != NULL)
+		    spot_monst(pp)->t_oldch = spot_ch(pp);
+		else if (spot_flags(pp) & F_REAL)
 		    addch(ch);
 		else
 		{
 		    standout();
-		    addch((pp->p_flags & F_PASS) ? PASSAGE : DOOR);
+		    addch((spot_flags(pp) & F_PASS) ? PASSAGE : DOOR);
 		    standend();
 		}
 	    }
@@ -357,8 +388,8 @@ add_pass(void)
  * passnum:
  *	Assign a number to each passageway
  */
-static int pnum;
-static int newpnum;
+static TLOCAL int pnum;
+static TLOCAL int newpnum;
 
 void
 passnum(void)
@@ -386,7 +417,7 @@ passnum(void)
 void
 numpass(int y, int x)
 {
-    int *fp;
+    pflag_t *fp;
     struct room *rp;
     int ch;
 
@@ -137,6 +137,7 @@ gethand(void)
 	    msg("left or right ring? ");
 	else
 	    msg("left hand or right hand? ");
+	show_prompt(PR_HAND);
 	if ((c = readchar()) == ESCAPE)
 	    return -1;
 	mpos = 0;
@@ -186,7 +187,7 @@ ring_eat(int hand)
 const char *
 ring_num(const THING *obj)
 {
-    static char buf[10];
+    static TLOCAL char buf[10];
 
     if (!(obj->o_flags & ISKNOW))
 	return "";
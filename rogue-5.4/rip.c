@@ -235,12 +235,13 @@ death(int monst)
 {
     char **dp;
     const char *killer;
-    struct tm *lt;
+    struct tm *lt, ltbuf;
     time_t date;
 
     signal(SIGINT, SIG_IGN);
     purse -= purse / 10;
     signal(SIGINT, leave);
+    show_end();
     clear();
     killer = killname(monst, FALSE);
     if (!tombstone)
@@ -254,7 +255,13 @@ death(int monst)
     else
     {
 	time(&date);
-	lt = localtime(&date);
+	/* localtime()'s buffer is shared by every game thread */
+#ifdef _WIN32
+	localtime_s(&ltbuf, &date);
+#else
+	localtime_r(&date, &ltbuf);
+#endif
+	lt = &ltbuf;
 	move(8, 0);
 	dp = rip;
 	while (*dp)
@@ -300,6 +307,7 @@ total_winner(void)
     int worth = 0;
     int oldpurse;
 
+    show_end();
     clear();
     standout();
     addstr("                                                               \n");
@@ -50,6 +50,15 @@
 #define	INV_SLOW	1
 #define	INV_CLEAR	2
 
+/*
+ * prompts the frontend is told about
+ */
+#define	PR_MORE		1	/* --More-- */
+#define	PR_NAME		2	/* call it */
+#define	PR_IDENTIFY	3	/* identify a monster or object character */
+#define	PR_ITEM		4	/* pick an object from the pack */
+#define	PR_HAND		5	/* left or right hand */
+
 /*
  * All the fun defines
  */
@@ -68,6 +77,8 @@
 #define attach(a,b)	_attach(&a,b)
 #define detach(a,b)	_detach(&a,b)
 #define free_list(a)	_free_list(&a)
+#define drop_list(a)	_drop_list(&a)
+#define keep_item(a,b)	_keep_item(&a,b)
 #undef max
 #define max(a,b)	((a) > (b) ? (a) : (b))
 #define on(thing,flag)	((((thing).t_flags & (flag)) != 0))
@@ -75,10 +86,10 @@
 #define ISRING(h,r)	(cur_ring[h] != NULL && cur_ring[h]->o_which == r)
 #define ISWEARING(r)	(ISRING(LEFT, r) || ISRING(RIGHT, r))
 #define ISMULT(type) 	(type == POTION || type == SCROLL || type == FOOD)
-#define INDEX(y,x)	(&places[((x) << 5) + (y)])
-#define chat(y,x)	(places[((x) << 5) + (y)].p_ch)
-#define flat(y,x)	(places[((x) << 5) + (y)].p_flags)
-#define moat(y,x)	(places[((x) << 5) + (y)].p_monst)
+#define chat(y,x)	spot_ch(INDEX(y,x))
+#define flat(y,x)	spot_flags(INDEX(y,x))
+#define moat(y,x)	spot_monst(INDEX(y,x))
+#define objat(y,x)	spot_obj(INDEX(y,x))
 #define unc(cp)		(cp).y, (cp).x
 #ifdef MASTER
 #define debug		if (wizard) msg
@@ -123,6 +134,7 @@
 #define STOMACHSIZE	2000
 #define STARVETIME	850
 #define ESCAPE		27
+#define TRAVEL		CTRL('_')	/* sent by the front end, see get_travel */
 #define LEFT		0
 #define RIGHT		1
 #define BOLT_LENGTH	6
@@ -441,14 +453,40 @@ typedef union thing THING;
 #define o_label		_o._o_label
 
 /*
- * describe a place on the level map
+ * describe a place on the level map.  Code walks the map through a
+ * MAPSPOT from INDEX() and the spot_* macros, so it does not care how
+ * the map is laid out.  With PLACES_SOA each field is its own dense
+ * array in row-major order, otherwise the map is one array of PLACEs
+ * column by column.
  */
+#ifdef PLACES_SOA
+typedef unsigned short pflag_t;
+typedef int MAPSPOT;
+
+#define INDEX(y,x)	((y) * MAXCOLS + (x))
+#define spot_ch(sp)	(place_ch[sp])
+#define spot_flags(sp)	(place_flags[sp])
+#define spot_monst(sp)	(place_monst[sp])
+#define spot_obj(sp)	(place_obj[sp])
+#else
+typedef int pflag_t;
+
 typedef struct PLACE {
     int p_ch;
-    int p_flags;
+    pflag_t p_flags;
     THING *p_monst;
+    THING *p_obj;		/* object lying here, kept by attach/detach */
 } PLACE;
 
+typedef PLACE *MAPSPOT;
+
+#define INDEX(y,x)	(&places[((x) << 5) + (y)])
+#define spot_ch(sp)	((sp)->p_ch)
+#define spot_flags(sp)	((sp)->p_flags)
+#define spot_monst(sp)	((sp)->p_monst)
+#define spot_obj(sp)	((sp)->p_obj)
+#endif
+
 /*
  * Array containing information on all the various types of monsters
  */
@@ -473,54 +511,68 @@ struct STONE {
 
 typedef struct STONE STONE;
 
+/*
+ * A game running on a thread of its own, see rogue_start()
+ */
+typedef struct rogue_context ROGUE_CONTEXT;
+
 /*
  * External variables
  */
 
-extern int after, again, allscore, door_stop, fight_flush,
-	   firstmove, has_hit, inv_describe, jump, kamikaze,
+extern TLOCAL int after, again, allscore, digging, door_stop, fight_flush,
+	   flow_chase, firstmove, has_hit, inv_describe, jump, kamikaze,
 	   lower_msg, move_on, msg_esc, pack_used[],
 	   passgo, playing, q_comm, running, save_msg, see_floor,
-	   seenstairs, stat_msg, terse, to_death, tombstone,
+	   seenstairs, stat_msg, terse, to_death, tombstone, travelling,
            amulet, count, dir_ch, food_left, hungry_state, inpack,
 	   inv_type, lastscore, level, max_hit, max_level, mpos, take,
 	   n_objs, no_command, no_food, no_move, noscore, ntraps, purse,
-	   quiet, vf_hit, runch, last_comm, l_last_comm, last_dir, l_last_dir,
-	   numscores, total, between, group, cNWOOD, cNMETAL, cNSTONES,
+	   quiet, turns, vf_hit, runch, travel_draw, travel_steps, autosave_turns, last_comm, l_last_comm, last_dir, l_last_dir,
+	   numscores, things_live, things_peak, lvl_things_live,
+	   lvl_things_peak, between, group, cNWOOD, cNMETAL, cNSTONES,
 	   cNCOLORS;
 
-extern char file_name[], home[], huh[], *Numname, outbuf[], 
-	    *ws_type[], *s_names[];
+extern TLOCAL char file_name[], home[], huh[], *Numname, outbuf[], 
+	    rogue_opts[], *ws_type[], *s_names[];
+
+extern TLOCAL const char *ws_made[], *inv_t_name[], *p_colors[],
+			 *r_stones[], *tr_name[];
 
-extern const char *ws_made[], *inv_t_name[], *p_colors[], *r_stones[], 
-                  *release, *tr_name[], *rainbow[], *wood[], *metal[],
-		  encstr[], statlist[], version[];
+extern const char *release, *rainbow[], *wood[], *metal[], encstr[],
+		  statlist[], version[];
 
 extern const int a_class[], e_levels[];
 
-extern unsigned int dnum, seed;
+extern TLOCAL unsigned int dnum, seed;
 
-extern WINDOW *hw;
+extern TLOCAL WINDOW *hw;
 
-extern coord delta, oldpos, stairs;
+extern TLOCAL coord delta, oldpos, stairs, travel_dest;
 
-extern PLACE places[];
+#ifdef PLACES_SOA
+extern TLOCAL unsigned char place_ch[MAXLINES*MAXCOLS];
+extern TLOCAL pflag_t place_flags[MAXLINES*MAXCOLS];
+extern TLOCAL THING *place_monst[MAXLINES*MAXCOLS], *place_obj[MAXLINES*MAXCOLS];
+#else
+extern TLOCAL PLACE places[];
+#endif
 
-extern THING *cur_armor, *cur_ring[], *cur_weapon, *l_last_pick,
+extern TLOCAL THING *cur_armor, *cur_ring[], *cur_weapon, *l_last_pick,
 	     *last_pick, *lvl_obj, *mlist, player;
 
 extern const struct h_list helpstr[];
 
-extern struct room *oldrp, passages[], rooms[];
+extern TLOCAL struct room *oldrp, passages[], rooms[];
 
-extern struct stats max_stats;
+extern TLOCAL struct stats max_stats;
 
-extern struct monster monsters[];
+extern TLOCAL struct monster monsters[];
 
-extern struct obj_info arm_info[], pot_info[], ring_info[],
+extern TLOCAL struct obj_info arm_info[], pot_info[], ring_info[],
 			scr_info[], things[], ws_info[], weap_info[];
 
-extern struct delayed_action d_list[MAXDAEMONS];
+extern TLOCAL struct delayed_action d_list[MAXDAEMONS];
 
 extern const STONE    stones[];
 
@@ -530,7 +582,10 @@ extern const STONE    stones[];
 
 void	_attach(THING **list, THING *item);
 void	_detach(THING **list, THING *item);
+void	_drop_list(THING **ptr);
 void	_free_list(THING **ptr);
+void	free_things(void);
+THING	*_keep_item(THING **list, THING *item);
 void	addmsg(const char *fmt, ...);
 int 	add_haste(int potion);
 int	add_line(const char *fmt, const char *arg);
@@ -541,6 +596,8 @@ void	accnt_maze(int y, int x, int ny, int nx);
 void	aggravate(void);
 int	attack(THING *mp);
 void    auto_save(int);
+void	autosave(void);
+void	autosave_end(void);
 void	badcheck(const char *name, const struct obj_info *info, int bound);
 int 	be_trapped(const coord *tc);
 void	bounce(const THING *weap, const char *mname, int noend);
@@ -553,6 +610,9 @@ int	checkout(void);
 const char *charge_str(const THING *obj);
 void	chg_str(int amt);
 void	check_level(void);
+void	clear_lvl_items(void);
+void	clear_places(void);
+void	check_objs(void);
 const char *choose_str(const char *ts, const char *ns);
 void	conn(int r1, int r2);
 void	come_down(void);
@@ -564,6 +624,7 @@ void	death(int monst);
 int 	death_monst(void);
 int	diag_ok(const coord *sp, const coord *ep);
 void	dig(int y, int x);
+void	dig_level(void);
 void	discard(THING *item);
 void	discovered(void);
 int	dist(int y1, int x1, int y2, int x2);
@@ -578,6 +639,7 @@ void	do_passages(void);
 void	do_pot(int type, int knowit);
 void	do_rooms(void);
 void	do_run(int ch);
+void	do_travel(void);
 void	do_zap(void);
 void	doadd(const char *fmt, va_list args);
 void	doctor(void);
@@ -585,6 +647,7 @@ void	door(struct room *rm, const coord *cp);
 void	door_open(const struct room *rp);
 void	drain(void);
 void	draw_room(const struct room *rp);
+void	drop_level(void);
 void	drop(void);
 int 	dropcheck(const THING *obj);
 void	eat(void);
@@ -620,6 +683,7 @@ THING   *get_item(const char *purpose, int type);
 int	get_num(void *vp, WINDOW *win);
 int	get_sf(void *vp, WINDOW *win);
 int	get_str(void *vopt, WINDOW *win);
+int	get_travel(coord *dest);
 int	gethand(void);
 void	getltchars(void);
 void	give_pack(THING *tp);
@@ -632,6 +696,7 @@ void	look(int wakeup);
 int	hit_monster(int y, int x, const THING *obj);
 void	identify(void);
 void	illcom(int ch);
+void	index_objs(void);
 void	init_check(void);
 void	init_colors(void);
 void	init_materials(void);
@@ -644,8 +709,14 @@ char	*inv_name(const THING *obj, int drop);
 int	inventory(const THING *list, int type);
 void	invis_on(void);
 int	is_current(const THING *obj);
+int	is_picking(void);
 int 	is_magic(const THING *obj);
 int     is_symlink(const char *sp); 
+int	jnl_close(void);
+int	jnl_open(const char *name, int replay);
+int	jnl_readchar(WINDOW *win);
+void	jnl_start(void);
+int	jnl_travel(int *y, int *x);
 void	kill_daemon(void (*func)());
 void	killed(THING *tp, int pr);
 const char *killname(int monst, int doart);
@@ -653,6 +724,7 @@ void	land(void);
 void    leave(int);
 THING   *leave_pack(THING *obj, int newobj, int all);
 int 	levit_check(void);
+int	load_image(FILE *inf);
 int	lock_sc(void);
 void	miss(const char *er, const char *ee, int noend);
 void	missile(int ydelta, int xdelta);
@@ -663,6 +735,7 @@ int	msg(const char *fmt, ...);
 void	my_exit(int sig);
 void	nameit(const THING *obj, const char *type, const char *which, const struct obj_info *op, const char *(*prfunc)(const THING *));
 THING   *new_item(void);
+THING   *new_lvl_item(void);
 void	new_level(void);
 void	new_monster(THING *tp, int type, const coord *cp);
 THING   *new_thing(void);
@@ -679,6 +752,7 @@ void	parse_opts(char *str);
 void 	passnum(void);
 int	passwd(void);
 const char *pick_color(const char *col);
+int	pick_fits(const THING *obj);
 int	pick_one(const struct obj_info *info, int nitems);
 void	pick_up(int ch);
 void	picky_inven(void);
@@ -689,6 +763,8 @@ void	pr_list(void);
 void	print_disc(int);
 void	put_bool(void *b);
 void	put_inv_t(void *ip);
+void	put_num(void *ip);
+void	put_stairs(void);
 void	put_str(void *str);
 void	put_things(void);
 void	putpass(const coord *cp);
@@ -703,6 +779,10 @@ void	remove_mon(const coord *mp, THING *tp, int waskill);
 void	reset_last(void);
 void    resetltchars(void);
 int     restore(const char *file);
+void	rogue_bind(ROGUE_CONTEXT *rc);
+void	rogue_finish(ROGUE_CONTEXT *rc);
+ROGUE_CONTEXT *rogue_start(int argc, char **argv, int input,
+		const char *journal, int replay);
 int	ring_eat(int hand);
 void	ring_on(void);
 void	ring_off(void);
@@ -715,13 +795,19 @@ int	roll(int number, int sides);
 int	roll_em(const THING *thatt, THING *thdef, const THING *weap, int hurl);
 void	rollwand(void);
 struct room *roomin(const coord *cp);
+char	*rs_image_end(size_t *lenp);
+void	rs_image_read(char *buf, size_t len);
+void	rs_image_write(size_t reserve);
+void	rs_read(FILE *savef, void *ptr, size_t size);
 int	rs_save_file(FILE *savef);
 int	rs_restore_file(FILE *inf);
+void	rs_write(FILE *savef, const void *ptr, size_t size);
 void	runners(void);
 void	runto(const coord *runner);
 void	rust_armor(THING *arm);
 int	save(int which);
 void	save_file(FILE *savef);
+int	save_image(FILE *savef);
 void	save_game(void);
 int	save_throw(int which, const THING *tp);
 void	score(int amount, int flags, int monst);
@@ -736,12 +822,21 @@ void	setup(void);
 void	shell(void);
 int 	show_floor(void);
 void	show_map(void);
+void	show_end(void);
+void	show_hero(void);
+void	show_lvl_objs(void);
+void	show_menu(int on);
+void	show_msg(const char *text);
+void	show_obj(const THING *obj, int on);
+void	show_prompt(int kind);
+void	show_status(const char *text);
 void	show_win(const char *message);
 void	sight(void);
 int	sign(int nm);
 int	spread(int nm);
 void	start_daemon(void (*func)(), int arg, int type);
 void	start_score(void);
+unsigned int state_hash(void);
 void	status(void);
 int	step_ok(int ch);
 void	stomach(void);
@@ -752,15 +847,18 @@ void	take_off(void);
 void	teleport(void);
 void	total_winner(void);
 void	thunk(const THING *weap, const char *mname, int noend);
+int	travel_dir(void);
 void	treas_room(void);
 int	trip_ch(int y, int x, int ch);
 void	tstp(int ignored);
 int     turn_ok(int y, int x);
 int	turn_see(int turn_off);
 void	turnref(void);
+int	type_fits(const THING *obj, int type);
 const char *type_name(int type);
 void	u_level(void);
 void	unconfuse(void);
+void	unload_image(void);
 void	uncurse(THING *obj);
 void	unlock_sc(void);
 void	unsee(void);
@@ -17,22 +17,382 @@
 #include <string.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <curses.h>
+#include <pthread.h>
 #include "rogue.h"
+#include "pdccc2dx.h"
 
-int rogue_running;
+t_pdc_context *newScreenContext(int input);
+void freeScreenContext(t_pdc_context *c);
+void bindScreenContext(t_pdc_context *c);
+
+/*
+ * A game and the thread it runs on.  Both that thread and whoever
+ * drives it bind the context, which hands each of them the game's
+ * screen and running flag.  Threads that bind nothing share the main
+ * game.  Games only stay apart when PDC_THREADS gives every thread its
+ * own globals.
+ */
+struct rogue_context {
+    pthread_t rc_thread;
+    t_pdc_context *rc_screen;		/* NULL for the main screen */
+    int rc_argc;
+    char **rc_argv;
+    const char *rc_journal;		/* to record to, or play back */
+    int rc_replay;
+    volatile int rc_running;		/* rogue_main() is playing */
+};
+
+static ROGUE_CONTEXT main_game;
+static TLOCAL ROGUE_CONTEXT *cur_game = &main_game;
 
 int is_rogue_running()
 {
-    return rogue_running;
+    return cur_game->rc_running;
+}
+
+/*
+ * rogue_bind:
+ *	Make this thread play, or talk to, the given game.  NULL goes
+ *	back to the main one
+ */
+void
+rogue_bind(ROGUE_CONTEXT *rc)
+{
+    if (rc == NULL)
+	rc = &main_game;
+    cur_game = rc;
+    bindScreenContext(rc->rc_screen);
+}
+
+/*
+ * rogue_thread:
+ *	Play a game started by rogue_start() and clean up after it
+ */
+static void *
+rogue_thread(void *arg)
+{
+    ROGUE_CONTEXT *rc = arg;
+    int i;
+
+    rogue_bind(rc);
+    rogue_main(rc->rc_argc, rc->rc_argv);
+    if (hw != NULL)
+	delwin(hw);
+    if (SP != NULL)
+	delscreen(SP);
+    free_things();
+    for (i = 0; i < MAXSCROLLS; i++)
+	free(s_names[i]);
+    rc->rc_running = FALSE;
+    return NULL;
+}
+
+/*
+ * rogue_start:
+ *	Start a game with a screen of its own on a new thread.  Bind the
+ *	context before pushing keys to it or reading its frames.  Ports
+ *	that read keys from a descriptor take this game's from input.
+ *	A journal, if named, is recorded to or with replay played back
+ */
+ROGUE_CONTEXT *
+rogue_start(int argc, char **argv, int input, const char *journal,
+    int replay)
+{
+    ROGUE_CONTEXT *rc;
+
+    if ((rc = calloc(1, sizeof *rc)) == NULL)
+	return NULL;
+    if ((rc->rc_screen = newScreenContext(input)) == NULL)
+    {
+	free(rc);
+	return NULL;
+    }
+    rc->rc_argc = argc;
+    rc->rc_argv = argv;
+    rc->rc_journal = journal;
+    rc->rc_replay = replay;
+    rc->rc_running = TRUE;
+    if (pthread_create(&rc->rc_thread, NULL, rogue_thread, rc) != 0)
+    {
+	freeScreenContext(rc->rc_screen);
+	free(rc);
+	return NULL;
+    }
+    return rc;
+}
+
+/*
+ * rogue_finish:
+ *	Wait for a game's thread to end, then throw the game away
+ */
+void
+rogue_finish(ROGUE_CONTEXT *rc)
+{
+    pthread_join(rc->rc_thread, NULL);
+    if (cur_game == rc)
+	rogue_bind(NULL);
+    freeScreenContext(rc->rc_screen);
+    free(rc);
+}
+
+void setScreenThing(int row, int col, int which);
+void clearScreenThings(void);
+void setScreenHero(int y, int x, int top, int left, int bottom, int right);
+void setScreenMode(int mode);
+void pushScreenEvent(const t_pdc_event *ev);
+void setScreenQuery(void (*handler)(t_pdc_snapshot *));
+
+/*
+ * show_obj:
+ *	Let the frontend know what kind of object lies (or no longer
+ *	lies) on a spot, so it never has to walk lvl_obj itself
+ */
+void
+show_obj(const THING *obj, int on)
+{
+    if (digging)
+	return;			/* not a level the frontend shows */
+    setScreenThing(obj->o_pos.y, obj->o_pos.x, on ? obj->o_which : -1);
+}
+
+/*
+ * show_lvl_objs:
+ *	Republish every object on the level
+ */
+void
+show_lvl_objs(void)
+{
+    THING *obj;
+
+    clearScreenThings();
+    for (obj = lvl_obj; obj != NULL; obj = next(obj))
+	show_obj(obj, TRUE);
+}
+
+/*
+ * show_hero:
+ *	Let the frontend know where the hero is and the bounds of the
+ *	room he is in, so it can follow him without searching the screen
+ */
+void
+show_hero(void)
+{
+    struct room *rp = proom;
+
+    if (rp == NULL || (rp->r_flags & ISGONE))
+	setScreenHero(hero.y, hero.x, -1, -1, -1, -1);
+    else
+	setScreenHero(hero.y, hero.x, rp->r_pos.y, rp->r_pos.x,
+	    rp->r_pos.y + rp->r_max.y - 1, rp->r_pos.x + rp->r_max.x - 1);
+}
+
+/*
+ * show_menu:
+ *	Tell the frontend whether a full screen window is up instead of
+ *	the map
+ */
+void
+show_menu(int on)
+{
+    setScreenMode(on ? PDC_MODE_MENU : PDC_MODE_MAP);
+}
+
+/*
+ * show_end:
+ *	The game is over, what follows is the tombstone and the scores
+ */
+void
+show_end(void)
+{
+    setScreenMode(PDC_MODE_END);
+}
+
+/*
+ * show_msg:
+ *	Hand the message line to the frontend, "" when it is cleared
+ */
+void
+show_msg(const char *text)
+{
+    t_pdc_event ev;
+
+    memset(&ev, 0, sizeof ev);
+    ev.type = PDC_EVENT_MESSAGE;
+    strncpy(ev.text, text, sizeof ev.text - 1);
+    pushScreenEvent(&ev);
 }
 
-int what_thing(int y, int x) {
-    THING *g = find_obj(y, x);
-    if (g != NULL) {
-        return g->_o._o_which;
+/*
+ * show_prompt:
+ *	Tell the frontend what kind of answer the game is waiting for
+ */
+void
+show_prompt(int kind)
+{
+    static const int pdc_prompt[] = {
+	0, PDC_PROMPT_MORE, PDC_PROMPT_NAME, PDC_PROMPT_IDENTIFY,
+	PDC_PROMPT_ITEM, PDC_PROMPT_HAND
+    };
+    t_pdc_event ev;
+
+    memset(&ev, 0, sizeof ev);
+    ev.type = PDC_EVENT_PROMPT;
+    ev.kind = pdc_prompt[kind];
+    pushScreenEvent(&ev);
+}
+
+/*
+ * get_travel:
+ *	Where the frontend wants the hero to go, sent along with TRAVEL
+ */
+int
+get_travel(coord *dest)
+{
+    int y, x;
+
+    if (!jnl_travel(&y, &x))
+	return FALSE;
+    if (y <= 0 || y >= NUMLINES - 1 || x < 0 || x >= NUMCOLS)
+	return FALSE;
+    dest->y = y;
+    dest->x = x;
+    return TRUE;
+}
+
+/*
+ * fill_stats:
+ *	The numbers behind the status line
+ */
+static void
+fill_stats(t_pdc_stats *st)
+{
+    st->level = level;
+    st->gold = purse;
+    st->hp = pstats.s_hpt;
+    st->hp_max = max_hp;
+    st->str = pstats.s_str;
+    st->str_max = max_stats.s_str;
+    st->arm = 10 - (cur_armor != NULL ? cur_armor->o_arm : pstats.s_arm);
+    st->exp_level = pstats.s_lvl;
+    st->exp = pstats.s_exp;
+    st->hunger = hungry_state;
+}
+
+/*
+ * show_status:
+ *	Hand the status line and the numbers behind it to the frontend
+ */
+void
+show_status(const char *text)
+{
+    t_pdc_event ev;
+
+    memset(&ev, 0, sizeof ev);
+    ev.type = PDC_EVENT_STATUS;
+    fill_stats(&ev.stats);
+    strncpy(ev.text, text, sizeof ev.text - 1);
+    pushScreenEvent(&ev);
+}
+
+/*
+ * fill_item:
+ *	Describe one object the way the inventory would, less the
+ *	"(being worn)" notes which go into the flags instead
+ */
+static void
+fill_item(t_pdc_item *it, const THING *obj)
+{
+    struct obj_info *op = NULL;
+
+    it->letter = (char) obj->o_packch;
+    it->type = (char) obj->o_type;
+    it->which = (short) obj->o_which;
+    it->count = (short) obj->o_count;
+    it->flags = 0;
+    if (obj == cur_weapon)
+	it->flags |= PDC_ITEM_WIELDED;
+    if (obj == cur_armor)
+	it->flags |= PDC_ITEM_WORN;
+    if (obj == cur_ring[LEFT])
+	it->flags |= PDC_ITEM_LEFT_HAND;
+    if (obj == cur_ring[RIGHT])
+	it->flags |= PDC_ITEM_RIGHT_HAND;
+    if (pick_fits(obj))
+	it->flags |= PDC_ITEM_PICKABLE;
+    switch (obj->o_type)
+    {
+	case POTION: op = &pot_info[obj->o_which];
+	when SCROLL: op = &scr_info[obj->o_which];
+	when RING: op = &ring_info[obj->o_which];
+	when STICK: op = &ws_info[obj->o_which];
+    }
+    if (op != NULL ? op->oi_know : (obj->o_flags & ISKNOW))
+	it->flags |= PDC_ITEM_KNOWN;
+    strncpy(it->name, inv_name(obj, FALSE), sizeof it->name - 1);
+    it->name[sizeof it->name - 1] = '\0';
+}
+
+/*
+ * query_game:
+ *	Fill in a snapshot of the pack, the discoveries and the stats.
+ *	Runs on the game thread while it waits for a key, so nothing
+ *	is half way through changing
+ */
+static void
+query_game(t_pdc_snapshot *snap)
+{
+    struct {
+	int type;
+	struct obj_info *info;
+	int max;
+    } kinds[] = {
+	{ POTION, pot_info, MAXPOTIONS },
+	{ SCROLL, scr_info, MAXSCROLLS },
+	{ RING, ring_info, MAXRINGS },
+	{ STICK, ws_info, MAXSTICKS },
+    };
+    static TLOCAL char saved[2*MAXSTR];
+    int describe = inv_describe;
+    THING *obj, disc;
+    int k, i;
+
+    /*
+     * inv_name() works in prbuf, which the interrupted command may
+     * still be using
+     */
+    memcpy(saved, prbuf, sizeof saved);
+    inv_describe = FALSE;
+
+    memset(snap, 0, sizeof *snap);
+    fill_stats(&snap->stats);
+    snap->picking = is_picking();
+    for (obj = pack; obj != NULL; obj = next(obj))
+    {
+	if (snap->item_count == PDC_SNAPSHOT_ITEMS)
+	    break;
+	fill_item(&snap->items[snap->item_count++], obj);
     }
-    return 0;
+
+    memset(&disc, 0, sizeof disc);
+    disc.o_count = 1;
+    for (k = 0; k < (int) (sizeof kinds / sizeof kinds[0]); k++)
+	for (i = 0; i < kinds[k].max; i++)
+	{
+	    if (!kinds[k].info[i].oi_know && !kinds[k].info[i].oi_guess)
+		continue;
+	    if (snap->discovery_count == PDC_SNAPSHOT_DISCOVERIES)
+		break;
+	    disc.o_type = kinds[k].type;
+	    disc.o_which = i;
+	    fill_item(&snap->discoveries[snap->discovery_count], &disc);
+	    snap->discoveries[snap->discovery_count++].flags &= ~PDC_ITEM_PICKABLE;
+	}
+
+    inv_describe = describe;
+    memcpy(prbuf, saved, sizeof saved);
 }
 
 /*
@@ -42,12 +402,14 @@ int what_thing(int y, int x) {
 int
 rogue_main(int argc, char **argv)
 {
-    rogue_running = TRUE;
+    cur_game->rc_running = TRUE;
     
     char *env;
     time_t lowtime;
+    struct stat sbuf;
 
     md_init();
+    setScreenQuery(query_game);
 
 #ifdef MASTER
     /*
@@ -80,10 +442,9 @@ rogue_main(int argc, char **argv)
     /*strcat(file_name, "rogue.save");*/
     strcat(file_name, "rogue54.sav");
 
+    rogue_opts[0] = '\0';
     if ((env = getenv("ROGUEOPTS")) != NULL)
-	parse_opts(env);
-    if (env == NULL || whoami[0] == '\0')
-        strucpy(whoami, md_getusername(), strlen(md_getusername()));
+	strncat(rogue_opts, env, MAXSTR - 1);
     lowtime = time(NULL);
     if (getenv("SEED") != NULL)
     {
@@ -92,6 +453,25 @@ rogue_main(int argc, char **argv)
     }
     else
 	dnum = (unsigned int) lowtime + md_getpid();
+
+    /*
+     * the main game is the process's own and may be told to keep a
+     * journal by the environment, others by rogue_start()
+     */
+    if (cur_game == &main_game)
+    {
+	if ((env = getenv("ROGUEREPLAY")) != NULL)
+	    main_game.rc_replay = TRUE;
+	else
+	    env = getenv("ROGUEJOURNAL");
+	main_game.rc_journal = env;
+    }
+    if (jnl_open(cur_game->rc_journal, cur_game->rc_replay))
+	noscore = 1;			/* a replay's own seed and options */
+    if (rogue_opts[0] != '\0')
+	parse_opts(rogue_opts);
+    if (rogue_opts[0] == '\0' || whoami[0] == '\0')
+        strucpy(whoami, md_getusername(), strlen(md_getusername()));
     seed = dnum;
 
     open_score();
@@ -131,9 +511,22 @@ rogue_main(int argc, char **argv)
     }
 
     init_check();			/* check for legal startup */
+    /*
+     * "-r" with no save file left to run on from is a new game, so a
+     * front end can always pass it and pick up its autosave
+     */
+    if (argc == 2 && strcmp(argv[1], "-r") == 0 && stat(file_name, &sbuf) < 0)
+	argc = 1;
     if (argc == 2)
-	if (!restore(argv[1]))	/* Note: restore will never return */
+    {
+	if (!restore(argv[1]))	/* returns once the game is over */
+	{
 	    my_exit(1);
+	    return(1);
+	}
+	return(jnl_close());
+    }
+    jnl_start();			/* new games only */
 #ifdef MASTER
     if (wizard)
 	printf("Hello %s, welcome to dungeon #%d", whoami, dnum);
@@ -185,7 +578,7 @@ rogue_main(int argc, char **argv)
     
     playit();
     
-    return(0);
+    return(jnl_close());
 }
 
 /*
@@ -288,8 +681,6 @@ tstp(int ignored)
 void
 playit(void)
 {
-    char *opts;
-
     /*
      * set up defaults for slow terminals
      */
@@ -307,8 +698,8 @@ playit(void)
     /*
      * parse environment declaration of options
      */
-    if ((opts = getenv("ROGUEOPTS")) != NULL)
-	parse_opts(opts);
+    if (rogue_opts[0] != '\0')
+	parse_opts(rogue_opts);
 
     oldpos = hero;
     oldrp = roomin(&hero);
@@ -368,7 +759,7 @@ quit(int sig)
 void
 leave(int sig)
 {
-    static char buf[BUFSIZ];
+    static TLOCAL char buf[BUFSIZ];
 
     NOOP(sig);
 
@@ -427,5 +818,8 @@ my_exit(int st)
     resetltchars();
     
     // exit(st);
-    rogue_running = FALSE;
+    autosave_end();
+    jnl_close();
+    playing = FALSE;			/* let rogue_main() return */
+    cur_game->rc_running = FALSE;
 }
@@ -32,6 +32,107 @@ do_run(int ch)
     runch = ch;
 }
 
+/*
+ * do_travel:
+ *	Start the hero travelling to the spot the front end picked.  It
+ *	runs like a CTRL run, but the direction is worked out afresh
+ *	before every step
+ */
+
+void
+do_travel(void)
+{
+    coord dest;
+
+    after = FALSE;
+    if (!get_travel(&dest) || ce(dest, hero))
+	return;
+    travel_dest = dest;
+    travelling = TRUE;
+    if ((runch = travel_dir()) == 0)
+    {
+	travelling = FALSE;
+	msg("you don't know the way there");
+	return;
+    }
+    if (!on(player, ISBLIND))
+    {
+	door_stop = TRUE;
+	firstmove = TRUE;
+    }
+    travel_steps = 0;
+    running = TRUE;
+}
+
+/*
+ * travel_ok:
+ *	Can the hero plan a way through this spot, going only by what
+ *	is on the screen
+ */
+static int
+travel_ok(int y, int x)
+{
+    int ch;
+
+    if (y == hero.y && x == hero.x)
+	return TRUE;
+    ch = CCHAR( mvinch(y, x) );
+    if (ch == TRAP)
+	return (y == travel_dest.y && x == travel_dest.x);
+    return (ch != ' ' && ch != '|' && ch != '-');
+}
+
+/*
+ * travel_dir:
+ *	The direction of the next step towards travel_dest, or 0 when
+ *	the hero is there or knows no way there.  The spots are counted
+ *	out from the destination, so the hero only has to step to any
+ *	neighbour that is one closer
+ */
+int
+travel_dir(void)
+{
+    static const char dirs[] = "kljhyunb";
+    static const int dy[] = { -1, 0, 1, 0, -1, -1, 1, 1 };
+    static const int dx[] = { 0, 1, 0, -1, -1, 1, -1, 1 };
+    static TLOCAL short dist[NUMLINES][NUMCOLS];
+    static TLOCAL coord queue[NUMLINES * NUMCOLS];
+    coord cp, np;
+    int head, tail, d, y, x;
+
+    for (y = 0; y < NUMLINES; y++)
+	for (x = 0; x < NUMCOLS; x++)
+	    dist[y][x] = -1;
+    dist[travel_dest.y][travel_dest.x] = 0;
+    queue[0] = travel_dest;
+    head = 0;
+    tail = 1;
+    while (head < tail && dist[hero.y][hero.x] < 0)
+    {
+	cp = queue[head++];
+	for (d = 0; d < 8; d++)
+	{
+	    np.y = cp.y + dy[d];
+	    np.x = cp.x + dx[d];
+	    if (!diag_ok(&cp, &np) || dist[np.y][np.x] >= 0
+		|| !travel_ok(np.y, np.x))
+		    continue;
+	    dist[np.y][np.x] = dist[cp.y][cp.x] + 1;
+	    queue[tail++] = np;
+	}
+    }
+    if (dist[hero.y][hero.x] <= 0)
+	return 0;
+    for (d = 0; d < 8; d++)
+    {
+	np.y = hero.y + dy[d];
+	np.x = hero.x + dx[d];
+	if (diag_ok(&hero, &np) && dist[np.y][np.x] == dist[hero.y][hero.x] - 1)
+	    return dirs[d];
+    }
+    return 0;
+}
+
 /*
  * do_move:
  *	Check to see that a move is legal.  If it is handle the
@@ -158,7 +259,8 @@ hit_bound:
 	    after = FALSE;
 	    break;
 	case DOOR:
-	    running = FALSE;
+	    if (!travelling)
+		running = FALSE;
 	    if (flat(hero.y, hero.x) & F_PASS)
 		enter_room(&nh);
 	    goto move_stuff;
@@ -207,11 +309,11 @@ move_stuff:
 int
 turn_ok(int y, int x)
 {
-    PLACE *pp;
+    MAPSPOT pp;
 
     pp = INDEX(y, x);
-    return (pp->p_ch == DOOR
-	|| (pp->p_flags & (F_REAL|F_PASS)) == (F_REAL|F_PASS));
+    return (spot_ch(pp) == DOOR
+	|| (spot_flags(pp) & (F_REAL|F_PASS)) == (F_REAL|F_PASS));
 }
 
 /*
@@ -222,10 +324,10 @@ turn_ok(int y, int x)
 void
 turnref(void)
 {
-    PLACE *pp;
+    MAPSPOT pp;
 
     pp = INDEX(hero.y, hero.x);
-    if (!(pp->p_flags & F_SEEN))
+    if (!(spot_flags(pp) & F_SEEN))
     {
 	if (jump)
 	{
@@ -233,7 +335,7 @@ turnref(void)
 	    refresh();
 	    leaveok(stdscr, FALSE);
 	}
-	pp->p_flags |= F_SEEN;
+	spot_flags(pp) |= F_SEEN;
     }
 }
 
@@ -262,7 +364,7 @@ door_open(const struct room *rp)
 int
 be_trapped(const coord *tc)
 {
-    PLACE *pp;
+    MAPSPOT pp;
     THING *arrow;
     int tr;
 
@@ -271,9 +373,9 @@ be_trapped(const coord *tc)
     running = FALSE;
     count = FALSE;
     pp = INDEX(tc->y, tc->x);
-    pp->p_ch = TRAP;
-    tr = pp->p_flags & F_TMASK;
-    pp->p_flags |= F_SEEN;
+    spot_ch(pp) = TRAP;
+    tr = spot_flags(pp) & F_TMASK;
+    spot_flags(pp) |= F_SEEN;
     switch (tr)
     {
 	case T_DOOR:
@@ -316,7 +418,7 @@ be_trapped(const coord *tc)
 	    }
 	    else
 	    {
-		arrow = new_item();
+		arrow = new_lvl_item();
 		init_weapon(arrow, ARROW);
 		arrow->o_count = 1;
 		arrow->o_pos = hero;
@@ -382,9 +484,7 @@ rndmove(const THING *who)
 	    goto bad;
 	if (ch == SCROLL)
 	{
-	    for (obj = lvl_obj; obj != NULL; obj = next(obj))
-		if (y == obj->o_pos.y && x == obj->o_pos.x)
-		    break;
+	    obj = objat(y, x);
 	    if (obj != NULL && obj->o_which == S_SCARE)
 		goto bad;
 	}
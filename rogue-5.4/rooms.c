@@ -120,7 +120,7 @@ do_rooms(void)
 	{
 	    THING *gold;
 
-	    gold = new_item();
+	    gold = new_lvl_item();
 	    gold->o_goldval = rp->r_goldval = GOLDCALC;
 	    find_floor(rp, &rp->r_gold, FALSE, FALSE);
 	    gold->o_pos = rp->r_gold;
@@ -135,7 +135,7 @@ do_rooms(void)
 	 */
 	if (rnd(100) < (rp->r_goldval > 0 ? 80 : 25))
 	{
-	    tp = new_item();
+	    tp = new_lvl_item();
 	    find_floor(rp, &mp, FALSE, TRUE);
 	    new_monster(tp, randmonster(FALSE), &mp);
 	    give_pack(tp);
@@ -205,9 +205,9 @@ horiz(const struct room *rp, int starty)
  *	Dig a maze
  */
 
-static int	Maxy, Maxx, Starty, Startx;
+static TLOCAL int	Maxy, Maxx, Starty, Startx;
 
-static SPOT	maze[NUMLINES/3+1][NUMCOLS/3+1];
+static TLOCAL SPOT	maze[NUMLINES/3+1][NUMCOLS/3+1];
 
 
 void
@@ -334,7 +334,7 @@ rnd_pos(const struct room *rp, coord *cp)
 int
 find_floor(const struct room *rp, coord *cp, int limit, int monst)
 {
-    PLACE *pp;
+    MAPSPOT pp;
     int cnt;
     int compchar = 0;
     int pickroom;
@@ -357,10 +357,10 @@ find_floor(const struct room *rp, coord *cp, int limit, int monst)
 	pp = INDEX(cp->y, cp->x);
 	if (monst)
 	{
-	    if (pp->p_monst == NULL && step_ok(pp->p_ch))
+	    if (spot_monst(pp) == NULL && step_ok(spot_ch(pp)))
 		return TRUE;
 	}
-	else if (pp->p_ch == compchar)
+	else if (spot_ch(pp) == compchar)
 	    return TRUE;
     }
 }
@@ -420,7 +420,7 @@ enter_room(const coord *cp)
 void
 leave_room(const coord *cp)
 {
-    PLACE *pp;
+    MAPSPOT pp;
     struct room *rp;
     int y, x;
     int floor;
@@ -464,7 +464,7 @@ leave_room(const coord *cp)
 			    break;
 			}
                         pp = INDEX(y,x);
-			addch(pp->p_ch == DOOR ? DOOR : floor);
+			addch(spot_ch(pp) == DOOR ? DOOR : floor);
 		    }
 	    }
 	}
@@ -17,9 +17,29 @@
 #include <signal.h>
 #include <string.h>
 #include <curses.h>
+#include <pthread.h>
+#include <sched.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 #include "rogue.h"
 #include "score.h"
 
+/*
+ * A save file is a header
+ *
+ *	"R54S" version length checksum
+ *
+ * (4-byte little endian words) followed by the image state.c builds
+ * in memory, encoded with enccode().  The checksum is taken before
+ * encoding.  Files without the header are the old kind, where every
+ * field went through encwrite() on its own, and still load
+ */
+#define SAVE_MAGIC	"R54S"
+#define SAVE_VERSION	1
+#define SAVE_HEADER	16
+
 /*
  * save_game:
  *	Implement the "save game" command
@@ -138,16 +158,12 @@ void
 save_file(FILE *savef)
 {
 #if 0
-    char buf[80];
     mvcur(0, COLS - 1, LINES - 1, 0); 
     putchar('\n');
     endwin();
     resetltchars();
     md_chmod(file_name, 0400);
-    encwrite(version, strlen(version)+1, savef);
-    sprintf(buf,"%d x %d\n", LINES, COLS);
-    encwrite(buf,80,savef);
-    rs_save_file(savef);
+    save_image(savef);
     fflush(savef);
     fclose(savef);
     exit(0);
@@ -157,12 +173,12 @@ save_file(FILE *savef)
 /*
  * restore:
  *	Restore a saved game from a file with elaborate checks for file
- *	integrity from cheaters
+ *	integrity from cheaters, and play it.  Returns TRUE once the
+ *	restored game is over, FALSE if it could not be restored
  */
 int
 restore(const char *file)
 {
-#if 0
     FILE *inf;
     int syml;
     char buf[MAXSTR];
@@ -183,13 +199,19 @@ restore(const char *file)
     syml = is_symlink(file);
 
     fflush(stdout);
-    encread(buf, strlen(version) + 1, inf);
+    if (load_image(inf) < 0)
+    {
+	printf("Sorry, saved game is damaged.\n");
+	return FALSE;
+    }
+    rs_read(inf, buf, strlen(version) + 1);
     if (strcmp(buf, version) != 0)
     {
 	printf("Sorry, saved game is out of date.\n");
+	unload_image();
 	return FALSE;
     }
-    encread(buf,80,inf);
+    rs_read(inf, buf, 80);
     (void) sscanf(buf,"%d x %d\n", &lines, &cols);
 
     initscr();                          /* Start up cursor package */
@@ -214,6 +236,9 @@ restore(const char *file)
     setup();
 
     rs_restore_file(inf);
+    unload_image();
+    index_objs();			/* lvl_obj was read in without attach */
+    show_lvl_objs();
     /*
      * we do not close the file so that we will have a hold of the
      * inode for as long as possible
@@ -260,15 +285,480 @@ restore(const char *file)
     clearok(curscr, TRUE);
     srand(md_getpid());
     msg("file name: %s", file);
+    autosave();				/* the save is gone, put it back */
     playit();
-    /*NOTREACHED*/
-    return(0);
+    return TRUE;
+}
+
+/*
+ * Save images: the game built in memory, sealed with a header and an
+ * Adler-32 sum, and encoded by enccode() with the same keystream one
+ * encwrite() of the whole image would use.  save_game() is still
+ * #if 0 here, so autosave() builds them; restore() maps them back in
+ * through load_image()
+ */
+
+/*
+ * put_word, get_word:
+ *	Header words are little endian whatever the machine
+ */
+static void
+put_word(char *p, unsigned int w)
+{
+    p[0] = (char) w;
+    p[1] = (char) (w >> 8);
+    p[2] = (char) (w >> 16);
+    p[3] = (char) (w >> 24);
+}
+
+static unsigned int
+get_word(const char *p)
+{
+    return (unsigned char) p[0] | (unsigned char) p[1] << 8
+	| (unsigned char) p[2] << 16 | (unsigned int) (unsigned char) p[3] << 24;
+}
+
+/*
+ * save_sum:
+ *	Adler-32 of an image
+ */
+static unsigned int
+save_sum(const char *buf, size_t size)
+{
+    unsigned int a = 1, b = 0;
+    size_t n;
+
+    while (size > 0)
+    {
+	n = size < 5552 ? size : 5552;	/* most bytes before b can overflow */
+	size -= n;
+	while (n--)
+	{
+	    a += (unsigned char) *buf++;
+	    b += a;
+	}
+	a %= 65521;
+	b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+/*
+ * enccode:
+ *	Encode or decode an image in place, with the keystream of
+ *	encwrite().  encstr against statlist repeats every l1 * l2
+ *	bytes, and the running feedback only depends on where in that
+ *	block it is and how many blocks came before, so both are laid
+ *	out once and applied a block at a time
+ */
+static void
+enccode(char *buf, size_t size)
+{
+    size_t l1 = strlen(encstr), l2 = strlen(statlist);
+    size_t klen = l1 * l2, i, n;
+    char *key, *fbk, fb, step;
+
+    if ((key = malloc(2 * klen)) == NULL)
+	return;
+    fbk = key + klen;
+    fb = 0;
+    for (i = 0; i < klen; i++)
+    {
+	key[i] = encstr[i % l1] ^ statlist[i % l2];
+	fbk[i] = fb;
+	fb = fb + (char) (encstr[i % l1] * statlist[i % l2]);
+    }
+    step = fb;				/* what one block adds */
+    for (fb = 0; size > 0; buf += n, size -= n, fb += step)
+    {
+	n = size < klen ? size : klen;
+	for (i = 0; i < n; i++)
+	    buf[i] ^= key[i] ^ (char) (fbk[i] + fb);
+    }
+    free(key);
+}
+
+/*
+ * build_image:
+ *	Put the whole game into a memory image, with room for the header
+ *	in front.  Returns NULL if something went wrong
+ */
+static char *
+build_image(size_t *sizep)
+{
+    char buf[80];
+
+    encclearerr();
+    rs_image_write(SAVE_HEADER);
+    rs_write(NULL, version, strlen(version) + 1);
+    memset(buf, 0, sizeof buf);
+    sprintf(buf, "%d x %d\n", LINES, COLS);
+    rs_write(NULL, buf, 80);
+    if (rs_save_file(NULL) != 0)
+    {
+	free(rs_image_end(sizep));
+	return NULL;
+    }
+    return rs_image_end(sizep);
+}
+
+/*
+ * seal_image:
+ *	Fill in the header and encode what build_image() made
+ */
+static void
+seal_image(char *img, size_t size)
+{
+    memcpy(img, SAVE_MAGIC, 4);
+    put_word(img + 4, SAVE_VERSION);
+    put_word(img + 8, (unsigned int) (size - SAVE_HEADER));
+    put_word(img + 12, save_sum(img + SAVE_HEADER, size - SAVE_HEADER));
+    enccode(img + SAVE_HEADER, size - SAVE_HEADER);
+}
+
+/*
+ * save_image:
+ *	Build the whole game in memory, encode it and write it out in
+ *	one go.  Returns 0, or the error that stopped it
+ */
+int
+save_image(FILE *savef)
+{
+    char *img;
+    size_t size;
+    int err = 0;
+
+    if ((img = build_image(&size)) == NULL)
+	return encerror() ? encerror() : ENOMEM;
+    seal_image(img, size);
+    if (fwrite(img, 1, size, savef) != size)
+	err = errno;
+    free(img);
+    return err;
+}
+
+/*
+ * Autosaves.  Off unless the front end asks for them with the
+ * autosave option (and, where the home directory is not writable, a
+ * file option that is).  Every autosave_turns turns command() has the
+ * game put into an image, which only costs copying it, and hands it
+ * to a thread of its own that encodes it and writes it to save.tmp
+ * and renames that over the save.  A killed game leaves either the
+ * last save or the one before.  If the writer is still busy the newer
+ * image replaces the one waiting.
+ *
+ * The save is file_name, where "rogue -r" looks for it, so a game
+ * the system killed is run on from there.  Games in one process need
+ * file options of their own: a second game that asks for a save some
+ * other game is writing is not autosaved.  The end of the game
+ * removes the save, a dead hero cannot be restored
+ */
+typedef struct autosave {
+    pthread_mutex_t as_lock;
+    pthread_cond_t as_ready;
+    int as_stop;			/* the writer should finish */
+    char *as_image;			/* waiting to be written */
+    size_t as_size;
+    char as_name[MAXSTR];		/* this game's save */
+    struct autosave *as_next;		/* the other games' writers */
+} AUTOSAVE;
+
+static TLOCAL AUTOSAVE *as = NULL;	/* the writer is running */
+static TLOCAL pthread_t as_thread;
+static TLOCAL int as_turn = -1;		/* turn of the last snapshot */
+
+static pthread_mutex_t as_games_lock = PTHREAD_MUTEX_INITIALIZER;
+static AUTOSAVE *as_games = NULL;	/* every writer in the process */
+
+/*
+ * as_write:
+ *	Write one image next to the save file and move it into place
+ */
+static void
+as_write(const char *name, char *img, size_t size)
+{
+    char tmp[MAXSTR + 8];
+    FILE *savef;
+    int ok;
+
+    sprintf(tmp, "%s.tmp", name);
+    if ((savef = fopen(tmp, "wb")) == NULL)
+	return;
+    seal_image(img, size);
+    ok = fwrite(img, 1, size, savef) == size && fflush(savef) == 0;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(savef)) == 0;
+#endif
+    fclose(savef);
+    if (!ok)
+    {
+	md_unlink(tmp);
+	return;
+    }
+#ifdef _WIN32
+    md_unlink((char *) name);	/* rename() will not replace a file here */
+#endif
+    if (rename(tmp, name) != 0)
+	md_unlink(tmp);
+}
+
+/*
+ * as_loop:
+ *	The writer thread, waiting for images until it is told to stop.
+ *	It shares nothing with the game but what arg points to
+ */
+static void *
+as_loop(void *arg)
+{
+    AUTOSAVE *ap = arg;
+    char *img;
+    size_t size;
+
+    pthread_mutex_lock(&ap->as_lock);
+    for (;;)
+    {
+	while (ap->as_image == NULL && !ap->as_stop)
+	    pthread_cond_wait(&ap->as_ready, &ap->as_lock);
+	if (ap->as_image == NULL)
+	    break;
+	img = ap->as_image;
+	size = ap->as_size;
+	ap->as_image = NULL;
+	pthread_mutex_unlock(&ap->as_lock);
+	as_write(ap->as_name, img, size);
+	free(img);
+	pthread_mutex_lock(&ap->as_lock);
+    }
+    pthread_mutex_unlock(&ap->as_lock);
+    return NULL;
+}
+
+/*
+ * as_claim:
+ *	Take file_name as this game's save, unless another game's
+ *	writer already has it
+ */
+static int
+as_claim(AUTOSAVE *ap)
+{
+    AUTOSAVE *op;
+
+    strcpy(ap->as_name, file_name);
+    pthread_mutex_lock(&as_games_lock);
+    for (op = as_games; op != NULL; op = op->as_next)
+	if (strcmp(op->as_name, ap->as_name) == 0)
+	{
+	    pthread_mutex_unlock(&as_games_lock);
+	    return FALSE;
+	}
+    ap->as_next = as_games;
+    as_games = ap;
+    pthread_mutex_unlock(&as_games_lock);
+    return TRUE;
+}
+
+/*
+ * as_unclaim:
+ *	Let another game have this one's save
+ */
+static void
+as_unclaim(AUTOSAVE *ap)
+{
+    AUTOSAVE **opp;
+
+    pthread_mutex_lock(&as_games_lock);
+    for (opp = &as_games; *opp != NULL; opp = &(*opp)->as_next)
+	if (*opp == ap)
+	{
+	    *opp = ap->as_next;
+	    break;
+	}
+    pthread_mutex_unlock(&as_games_lock);
+}
+
+/*
+ * as_start:
+ *	Claim this game's save file and start the writer for it
+ */
+static AUTOSAVE *
+as_start(void)
+{
+    AUTOSAVE *ap;
+    pthread_attr_t attr;
+    int ok;
+#ifdef SCHED_IDLE
+    struct sched_param sp;
+#endif
+
+    if ((ap = calloc(1, sizeof *ap)) == NULL)
+	return NULL;
+    if (!as_claim(ap))
+    {
+	free(ap);
+	return NULL;
+    }
+    pthread_mutex_init(&ap->as_lock, NULL);
+    pthread_cond_init(&ap->as_ready, NULL);
+    pthread_attr_init(&attr);
+#ifdef SCHED_IDLE
+    /*
+     * it only ever waits on the disk, let it have what is left over
+     */
+    memset(&sp, 0, sizeof sp);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_IDLE);
+    pthread_attr_setschedparam(&attr, &sp);
+#endif
+    ok = pthread_create(&as_thread, &attr, as_loop, ap) == 0;
+#ifdef SCHED_IDLE
+    if (!ok)
+	ok = pthread_create(&as_thread, NULL, as_loop, ap) == 0;
+#endif
+    pthread_attr_destroy(&attr);
+    if (!ok)
+    {
+	as_unclaim(ap);
+	pthread_mutex_destroy(&ap->as_lock);
+	pthread_cond_destroy(&ap->as_ready);
+	free(ap);
+	return NULL;
+    }
+    return ap;
+}
+
+/*
+ * autosave:
+ *	Called between commands; take a snapshot when one is due.  The
+ *	first one is due straight away, for a restored game as much as a
+ *	new one, as restore() has unlinked the save it came from
+ */
+void
+autosave(void)
+{
+    char *img, *old;
+    size_t size;
+
+    if (autosave_turns <= 0 || !playing || file_name[0] == '\0'
+	|| (as_turn >= 0 && turns - as_turn < autosave_turns))
+	return;
+    as_turn = turns;
+    if (as == NULL && (as = as_start()) == NULL)
+	return;
+    if ((img = build_image(&size)) == NULL)
+	return;
+    pthread_mutex_lock(&as->as_lock);
+    old = as->as_image;
+    as->as_image = img;
+    as->as_size = size;
+    pthread_cond_signal(&as->as_ready);
+    pthread_mutex_unlock(&as->as_lock);
+    free(old);
+}
+
+/*
+ * autosave_end:
+ *	The game is over: finish the writer and, as a dead hero cannot
+ *	be restored, take away the file it wrote
+ */
+void
+autosave_end(void)
+{
+    as_turn = -1;
+    if (as == NULL)
+	return;
+    pthread_mutex_lock(&as->as_lock);
+    free(as->as_image);
+    as->as_image = NULL;
+    as->as_stop = TRUE;
+    pthread_cond_signal(&as->as_ready);
+    pthread_mutex_unlock(&as->as_lock);
+    pthread_join(as_thread, NULL);
+    md_unlink(as->as_name);
+    as_unclaim(as);
+    pthread_mutex_destroy(&as->as_lock);
+    pthread_cond_destroy(&as->as_ready);
+    free(as);
+    as = NULL;
+}
+
+static TLOCAL char  *loaded = NULL;	/* file load_image() mapped */
+static TLOCAL size_t loaded_size = 0;
+
+/*
+ * load_image:
+ *	Map a save file and decode it where it lies, so that rs_read()
+ *	takes the game from memory.  Returns 1 when it did, 0 for an old
+ *	save (which rs_read() decodes from the file as before) and -1
+ *	for one that is damaged or too new
+ */
+int
+load_image(FILE *inf)
+{
+    char head[SAVE_HEADER];
+    unsigned int len;
+    struct stat sbuf;
+
+    if (fread(head, 1, SAVE_HEADER, inf) != SAVE_HEADER
+	|| memcmp(head, SAVE_MAGIC, 4) != 0)
+    {
+	rewind(inf);
+	return 0;
+    }
+    len = get_word(head + 8);
+    if (get_word(head + 4) > SAVE_VERSION || fstat(fileno(inf), &sbuf) < 0
+	|| (size_t) sbuf.st_size != SAVE_HEADER + (size_t) len)
+	return -1;
+    loaded_size = (size_t) sbuf.st_size;
+#ifndef _WIN32
+    loaded = mmap(NULL, loaded_size, PROT_READ|PROT_WRITE, MAP_PRIVATE,
+	fileno(inf), 0);
+    if (loaded == MAP_FAILED)
+	loaded = NULL;
+#else
+    if ((loaded = malloc(loaded_size)) != NULL)
+    {
+	rewind(inf);
+	if (fread(loaded, 1, loaded_size, inf) != loaded_size)
+	{
+	    free(loaded);
+	    loaded = NULL;
+	}
+    }
+#endif
+    if (loaded == NULL)
+	return -1;
+    enccode(loaded + SAVE_HEADER, len);
+    if (save_sum(loaded + SAVE_HEADER, len) != get_word(head + 12))
+    {
+	unload_image();
+	return -1;
+    }
+    rs_image_read(loaded + SAVE_HEADER, len);
+    return 1;
+}
+
+/*
+ * unload_image:
+ *	Let go of what load_image() mapped
+ */
+void
+unload_image(void)
+{
+    size_t size;
+
+    rs_image_end(&size);
+    if (loaded == NULL)
+	return;
+#ifndef _WIN32
+    munmap(loaded, loaded_size);
 #else
-    return FALSE;
+    free(loaded);
 #endif
+    loaded = NULL;
+    loaded_size = 0;
 }
 
-static int encerrno = 0;
+static TLOCAL int encerrno = 0;
 
 int
 encerror()
@@ -23,7 +23,7 @@ void
 read_scroll(void)
 {
     THING *obj;
-    PLACE *pp;
+    MAPSPOT pp;
     int y, x;
     int ch;
     int i;
@@ -141,7 +141,7 @@ read_scroll(void)
 		msg("you hear a faint cry of anguish in the distance");
 	    else
 	    {
-		obj = new_item();
+		obj = new_lvl_item();
 		new_monster(obj, randmonster(FALSE), &mp);
 	    }
 	when S_ID_POTION:
@@ -172,7 +172,7 @@ read_scroll(void)
 		for (x = 0; x < NUMCOLS; x++)
 		{
 		    pp = INDEX(y, x);
-		    switch (ch = pp->p_ch)
+		    switch (ch = spot_ch(pp))
 		    {
 			case DOOR:
 			case STAIRS:
@@ -180,49 +180,49 @@ read_scroll(void)
 
 			case '-':
 			case '|':
-			    if (!(pp->p_flags & F_REAL))
+			    if (!(spot_flags(pp) & F_REAL))
 			    {
-				ch = pp->p_ch = DOOR;
-				pp->p_flags |= F_REAL;
+				ch = spot_ch(pp) = DOOR;
+				spot_flags(pp) |= F_REAL;
 			    }
 			    break;
 
 			case ' ':
-			    if (pp->p_flags & F_REAL)
+			    if (spot_flags(pp) & F_REAL)
 				goto def;
-			    pp->p_flags |= F_REAL;
-			    ch = pp->p_ch = PASSAGE;
+			    spot_flags(pp) |= F_REAL;
+			    ch = spot_ch(pp) = PASSAGE;
 			    /* FALLTHROUGH */
 
 			case PASSAGE:
 pass:
-			    if (!(pp->p_flags & F_REAL))
-				pp->p_ch = PASSAGE;
-			    pp->p_flags |= (F_SEEN|F_REAL);
+			    if (!(spot_flags(pp) & F_REAL))
+				spot_ch(pp) = PASSAGE;
+			    spot_flags(pp) |= (F_SEEN|F_REAL);
 			    ch = PASSAGE;
 			    break;
 
 			case FLOOR:
-			    if (pp->p_flags & F_REAL)
+			    if (spot_flags(pp) & F_REAL)
 				ch = ' ';
 			    else
 			    {
 				ch = TRAP;
-				pp->p_ch = TRAP;
-				pp->p_flags |= (F_SEEN|F_REAL);
+				spot_ch(pp) = TRAP;
+				spot_flags(pp) |= (F_SEEN|F_REAL);
 			    }
 			    break;
 
 			default:
 def:
-			    if (pp->p_flags & F_PASS)
+			    if (spot_flags(pp) & F_PASS)
 				goto pass;
 			    ch = ' ';
 			    break;
 		    }
 		    if (ch != ' ')
 		    {
-			if ((obj = pp->p_monst) != NULL)
+			if ((obj = spot_monst(pp)) != NULL)
 			    obj->t_oldch = ch;
 			if (obj == NULL || !on(player, SEEMONST))
 			    mvaddch(y, x, ch);
@@ -67,22 +67,103 @@
 #define READSTAT (format_error || read_error )
 #define WRITESTAT (write_error)
 
-static int read_error   = FALSE;
-static int write_error  = FALSE;
-static int format_error = FALSE;
+static TLOCAL int read_error   = FALSE;
+static TLOCAL int write_error  = FALSE;
+static TLOCAL int format_error = FALSE;
 static int endian = 0x01020304;
 #define  big_endian ( *((char *)&endian) == 0x01 )
 
+/*
+ * With a save image open, rs_write() and rs_read() work on memory and
+ * save.c encodes the whole image at once, rather than each field going
+ * through encwrite()/encread() and the file on its own
+ */
+static TLOCAL char  *image = NULL;
+static TLOCAL size_t image_len = 0;	/* bytes written, or to read */
+static TLOCAL size_t image_size = 0;	/* bytes allocated */
+static TLOCAL size_t image_pos = 0;	/* next byte to read */
+static TLOCAL int    image_mode = 0;	/* 'w' or 'r' while one is open */
+
+void
+rs_image_write(size_t reserve)
+{
+    image_size = reserve + 65536;
+    if ((image = malloc(image_size)) == NULL)
+    {
+	encseterr(ENOMEM);
+	return;
+    }
+    memset(image, 0, reserve);
+    image_len = reserve;
+    image_mode = 'w';
+}
+
+void
+rs_image_read(char *buf, size_t len)
+{
+    image = buf;
+    image_len = len;
+    image_pos = 0;
+    image_mode = 'r';
+}
+
+char *
+rs_image_end(size_t *lenp)
+{
+    char *buf = image;
+
+    *lenp = image_len;
+    image = NULL;
+    image_len = image_size = image_pos = 0;
+    image_mode = 0;
+    return buf;
+}
+
 void
 rs_write(FILE *savef, const void *ptr, size_t size)
 {
-    encwrite(ptr, size, savef);
+    char *grown;
+
+    if (image_mode != 'w')
+    {
+	encwrite(ptr, size, savef);
+	return;
+    }
+    if (encerror() || image == NULL || size == 0)
+	return;
+    if (image_len + size > image_size)
+    {
+	while (image_len + size > image_size)
+	    image_size *= 2;
+	if ((grown = realloc(image, image_size)) == NULL)
+	{
+	    encseterr(ENOMEM);
+	    return;
+	}
+	image = grown;
+    }
+    memcpy(image + image_len, ptr, size);
+    image_len += size;
 }
 
 void
 rs_read(FILE *savef, void *ptr, size_t size)
 {
-    encread(ptr, size, savef);
+    if (image_mode != 'r')
+    {
+	encread(ptr, size, savef);
+	return;
+    }
+    if (encerror() || size == 0)
+	return;
+    if (size > image_len - image_pos)
+    {
+	memset(ptr, 0, size);
+	encseterr(EILSEQ);
+	return;
+    }
+    memcpy(ptr, image + image_pos, size);
+    image_pos += size;
 }
 
 void
@@ -660,13 +741,13 @@ rs_read_daemons(FILE *savef, struct delayed_action *dlist, int cnt)
             default:dlist[i].d_func = NULL;
                     break;
         }
-    }
 
-    if (dlist[i].d_func == NULL)
-    {
-        dlist[i].d_type = 0;
-        dlist[i].d_arg = 0;
-        dlist[i].d_time = 0;
+        if (dlist[i].d_func == NULL)
+        {
+            dlist[i].d_type = 0;
+            dlist[i].d_arg = 0;
+            dlist[i].d_time = 0;
+        }
     }
 }       
         
@@ -1289,30 +1370,38 @@ rs_read_thing_references(FILE *savef, THING *list, THING *items[], int cnt)
         rs_read_thing_reference(savef,list,&items[i]);
 }
 
+/*
+ * the map always goes out column by column, whatever layout
+ * the places are kept in
+ */
 void
-rs_write_places(FILE *savef, PLACE *p, int cnt)
+rs_write_places(FILE *savef)
 {
-    int i = 0;
+    int x, y;
     
-    for(i = 0; i < cnt; i++) 
-    {
-        rs_write_int(savef, p[i].p_ch);
-        rs_write_int(savef, p[i].p_flags);
-        rs_write_thing_reference(savef, mlist, p[i].p_monst);
-    }
+    for(x = 0; x < MAXCOLS; x++) 
+        for(y = 0; y < MAXLINES; y++) 
+        {
+            rs_write_int(savef, chat(y,x));
+            rs_write_int(savef, flat(y,x));
+            rs_write_thing_reference(savef, mlist, moat(y,x));
+        }
 }
 
 void
-rs_read_places(FILE *savef, PLACE *p, int cnt)
+rs_read_places(FILE *savef)
 {
-    int i = 0;
+    int x, y, i;
     
-    for(i = 0; i < cnt; i++) 
-    {
-        rs_read_int(savef,&p[i].p_ch);
-        rs_read_int(savef,&p[i].p_flags);
-        rs_read_thing_reference(savef, mlist, &p[i].p_monst);
-    }
+    for(x = 0; x < MAXCOLS; x++) 
+        for(y = 0; y < MAXLINES; y++) 
+        {
+            rs_read_int(savef,&i);
+            chat(y,x) = i;
+            rs_read_int(savef,&i);
+            flat(y,x) = i;
+            rs_read_thing_reference(savef, mlist, &moat(y,x));
+        }
 }
 
 int
@@ -1361,7 +1450,7 @@ rs_save_file(FILE *savef)
     rs_write_object_reference(savef, player.t_pack, cur_weapon); 
     rs_write_object_list(savef, lvl_obj);               
     rs_write_thing_list(savef, mlist);                
-    rs_write_places(savef,places,MAXLINES*MAXCOLS);
+    rs_write_places(savef);
     rs_write_stats(savef,&max_stats); 
     rs_write_rooms(savef, rooms, MAXROOMS);             
     rs_write_rooms(savef, passages, MAXPASS);
@@ -1429,7 +1518,7 @@ rs_restore_file(FILE *savef)
     rs_read_thing_list(savef, &mlist);                  
     rs_fix_thing(&player);
     rs_fix_thing_list(mlist);
-    rs_read_places(savef,places,MAXLINES*MAXCOLS);
+    rs_read_places(savef);
     rs_read_stats(savef, &max_stats);
     rs_read_rooms(savef, rooms, MAXROOMS);
     rs_read_rooms(savef, passages, MAXPASS);
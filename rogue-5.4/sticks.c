@@ -419,7 +419,7 @@ def:
 const char *
 charge_str(const THING *obj)
 {
-    static char buf[20];
+    static TLOCAL char buf[20];
 
     if (!(obj->o_flags & ISKNOW))
 	buf[0] = '\0';
@@ -160,10 +160,10 @@ drop(void)
     /*
      * Link it into the level object list
      */
+    obj->o_pos = hero;
     attach(lvl_obj, obj);
     chat(hero.y, hero.x) = obj->o_type;
     flat(hero.y, hero.x) |= F_DROPPED;
-    obj->o_pos = hero;
     if (obj->o_type == AMULET)
 	amulet = FALSE;
     msg("dropped %s", inv_name(obj, TRUE));
@@ -220,7 +220,7 @@ new_thing(void)
     THING *cur;
     int r;
 
-    cur = new_item();
+    cur = new_lvl_item();
     cur->o_hplus = 0;
     cur->o_dplus = 0;
     strncpy(cur->o_damage, "0x0", sizeof(cur->o_damage));
@@ -333,11 +333,11 @@ pick_one(const struct obj_info *info, int nitems)
  * discovered:
  *	list what the player has discovered in this game of a certain type
  */
-static int line_cnt = 0;
+static TLOCAL int line_cnt = 0;
 
-static int newpage = FALSE;
+static TLOCAL int newpage = FALSE;
 
-static const char *lastfmt, *lastarg;
+static TLOCAL const char *lastfmt, *lastarg;
 
 
 void
@@ -477,7 +477,7 @@ add_line(const char *fmt, const char *arg)
     WINDOW *tw, *sw;
     int x, y;
     char *prompt = "--Press space to continue--";
-    static int maxlen = -1;
+    static TLOCAL int maxlen = -1;
 
     if (line_cnt == 0)
     {
@@ -538,8 +538,10 @@ add_line(const char *fmt, const char *arg)
 	    {
 		wmove(hw, LINES - 1, 0);
 		waddstr(hw, prompt);
+		show_menu(TRUE);
 		wrefresh(hw);
 		wait_for(hw, ' ');
+		show_menu(FALSE);
 		clearok(curscr, TRUE);
 		wclear(hw);
 		touchwin(stdscr);
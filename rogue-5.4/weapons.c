@@ -119,18 +119,18 @@ do_motion(THING *obj, int ydelta, int xdelta)
 void
 fall(THING *obj, int pr)
 {
-    PLACE *pp;
+    MAPSPOT pp;
     coord fpos;
 
     if (fallpos(&obj->o_pos, &fpos))
     {
 	pp = INDEX(fpos.y, fpos.x);
-	pp->p_ch = obj->o_type;
+	spot_ch(pp) = obj->o_type;
 	obj->o_pos = fpos;
 	if (cansee(fpos.y, fpos.x))
 	{
-	    if (pp->p_monst != NULL)
-		pp->p_monst->t_oldch = obj->o_type;
+	    if (spot_monst(pp) != NULL)
+		spot_monst(pp)->t_oldch = obj->o_type;
 	    else
 		mvaddch(fpos.y, fpos.x, obj->o_type);
 	}
@@ -207,7 +207,7 @@ hit_monster(int y, int x, const THING *obj)
 const char *
 num(int n1, int n2, int type)
 {
-    static char numbuf[10];
+    static TLOCAL char numbuf[10];
 
     sprintf(numbuf, n1 < 0 ? "%d" : "+%d", n1);
     if (type == WEAPON)